@@ -30,6 +30,7 @@ SOFTWARE.
 #include "lang/interp.h"
 #include "lang/compile.h"
 #include "lang/err.h"
+#include "lang/type_number.h"
 
 int output(const char *s);
 
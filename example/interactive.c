@@ -108,13 +108,11 @@ static void print_error(int error)
 static void print_value(val_t *v)
 {
     if (val_is_number(v)) {
-        char buf[32];
-        if (*v & 0xffff) {
-            snprintf(buf, 32, "%f\n", val_2_double(v));
-        } else {
-            snprintf(buf, 32, "%d\n", (int)val_2_double(v));
-        }
+        char buf[NUMBER_STR_MAX];
+
+        number_to_cstr(val_2_double(v), buf);
         output(buf);
+        output("\n");
     } else
     if (val_is_boolean(v)) {
         output(val_2_intptr(v) ? "true\n" : "false\n");
@@ -28,12 +28,9 @@ SOFTWARE.
 static void print_value(val_t *v)
 {
     if (val_is_number(v)) {
-        char buf[32];
-        if (*v & 0xffff) {
-            snprintf(buf, 32, "%f", val_2_double(v));
-        } else {
-            snprintf(buf, 32, "%d", (int)val_2_double(v));
-        }
+        char buf[NUMBER_STR_MAX];
+
+        number_to_cstr(val_2_double(v), buf);
         output(buf);
     } else
     if (val_is_boolean(v)) {
@@ -75,11 +72,14 @@ static val_t print(env_t *env, int ac, val_t *av)
 }
 
 static native_t native_entry[] = {
-    {"print", print}
+    {"print", print},
+    {"parseInt", number_native_parse_int},
+    {"parseFloat", number_native_parse_float},
+    {"Number", number_native_create},
 };
 
 int native_init(env_t *env)
 {
-    return env_native_set(env, native_entry, 1);
+    return env_native_set(env, native_entry, sizeof(native_entry) / sizeof(native_entry[0]));
 }
 
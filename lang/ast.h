@@ -114,6 +114,8 @@ enum STMT_TYPE {
     STMT_VAR,
     STMT_RET,
     STMT_WHILE,
+    STMT_FOR_IN,
+    STMT_FOR_OF,
     STMT_BREAK,
     STMT_CONTINUE,
     STMT_THROW,
@@ -151,6 +151,19 @@ int bcode_parse(const uint8_t *code, int *offset, const char **name, int *param1
                         *param1 = (index << 8) | (code[shift++]);
                         *name  = "DICT"; if(offset) *offset = shift; return 1;
 
+    case BC_CONCAT:     *param1 = code[shift++];
+                        *name = "CONCAT"; if(offset) *offset = shift; return 1;
+
+    case BC_FOR_IN:     *param1 = code[shift++];
+                        index = (int8_t) (code[shift++]);
+                        *param2 = (index << 8) | (code[shift++]);
+                        *name = "FOR_IN"; if(offset) *offset = shift; return 2;
+
+    case BC_FOR_OF:     *param1 = code[shift++];
+                        index = (int8_t) (code[shift++]);
+                        *param2 = (index << 8) | (code[shift++]);
+                        *name = "FOR_OF"; if(offset) *offset = shift; return 2;
+
     case BC_PROP:       *name = "PROP"; if(offset) *offset = shift; return 0;
     case BC_PROP_METH:  *name = "PROP_METH"; if(offset) *offset = shift; return 0;
 
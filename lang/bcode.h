@@ -149,6 +149,11 @@ typedef enum bcode_t {
     BC_ARRAY,
     BC_DICT,
 
+    BC_CONCAT,
+
+    BC_FOR_IN,
+    BC_FOR_OF,
+
 } bcode_t;
 
 int bcode_parse(const uint8_t *code, int *offset, const char **name, int *param1, int *param2);
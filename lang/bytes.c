@@ -0,0 +1,105 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "bytes.h"
+
+typedef uintptr_t word_t;
+
+#define WORD_SIZE       ((int) sizeof(word_t))
+#define WORD_ONES       ((word_t) -1 / 0xFF)
+#define WORD_HIGHS      (WORD_ONES * 0x80)
+
+// Not zero if any byte of w is zero
+static inline word_t word_has_zero(word_t w) {
+    return (w - WORD_ONES) & ~w & WORD_HIGHS;
+}
+
+static inline word_t word_load(const char *p) {
+    word_t w;
+
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+int bytes_find_byte(const char *s, int len, char c)
+{
+    word_t pattern = WORD_ONES * (uint8_t) c;
+    int i;
+
+    for (i = 0; i + WORD_SIZE <= len; i += WORD_SIZE) {
+        if (word_has_zero(word_load(s + i) ^ pattern)) {
+            break;
+        }
+    }
+
+    for (; i < len; i++) {
+        if (s[i] == c) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static inline int bytes_match_at(const char *s, const char *f, int flen) {
+    return s[0] == f[0] && s[flen - 1] == f[flen - 1] && !memcmp(s + 1, f + 1, flen - 2);
+}
+
+/*
+ * Positions of a word are filtered by the first and the last byte of f,
+ * the candidates are checked with memcmp.
+ */
+int bytes_find(const char *s, int len, const char *f, int flen)
+{
+    word_t first, last;
+    int end = len - flen;
+    int i;
+
+    if (flen < 2) {
+        return flen == 1 ? bytes_find_byte(s, len, f[0]) : (flen == 0 ? 0 : -1);
+    }
+
+    first = WORD_ONES * (uint8_t) f[0];
+    last  = WORD_ONES * (uint8_t) f[flen - 1];
+
+    for (i = 0; i + WORD_SIZE <= end + 1; i += WORD_SIZE) {
+        word_t w = (word_load(s + i) ^ first) | (word_load(s + i + flen - 1) ^ last);
+
+        if (word_has_zero(w)) {
+            int k;
+
+            for (k = 0; k < WORD_SIZE; k++) {
+                if (bytes_match_at(s + i + k, f, flen)) {
+                    return i + k;
+                }
+            }
+        }
+    }
+
+    for (; i <= end; i++) {
+        if (bytes_match_at(s + i, f, flen)) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,48 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __LANG_BYTES_INC__
+#define __LANG_BYTES_INC__
+
+#include "config.h"
+
+/*
+ * Byte kernels of string, driven by known length instead of '\0'.
+ * Words are processed at a time (SWAR), no special instruction is required.
+ */
+
+int bytes_find_byte(const char *s, int len, char c);
+int bytes_find(const char *s, int len, const char *f, int flen);
+
+static inline int bytes_is_equal(const char *a, int alen, const char *b, int blen) {
+    return alen == blen && !memcmp(a, b, alen);
+}
+
+static inline int bytes_compare(const char *a, int alen, const char *b, int blen) {
+    int r = memcmp(a, b, alen < blen ? alen : blen);
+
+    return r ? r : alen - blen;
+}
+
+#endif /* __LANG_BYTES_INC__ */
@@ -0,0 +1,252 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "checksum.h"
+
+#define CRC32_POLY      (0xEDB88320u)   // reversed 0x04C11DB7
+#define CRC32C_POLY     (0x82F63B78u)   // reversed 0x1EDC6F41
+
+#define ADLER_MOD       (65521)
+#define ADLER_NMAX      (5552)          // max bytes before sums overflow
+
+#define XXH_P1          (0x9E3779B185EBCA87ull)
+#define XXH_P2          (0xC2B2AE3D27D4EB4Full)
+#define XXH_P3          (0x165667B19E3779F9ull)
+#define XXH_P4          (0x85EBCA77C2B2AE63ull)
+#define XXH_P5          (0x27D4EB2F165667C5ull)
+
+#if defined(__GNUC__) && defined(__x86_64__)
+# define CRC32C_HW      1
+#else
+# define CRC32C_HW      0
+#endif
+
+typedef uint32_t crc_table_t[8][256];
+
+// Tables are built at the first use, 8K bytes for each
+static crc_table_t crc32_table;
+static crc_table_t crc32c_table;
+
+static inline uint32_t load_le32(const uint8_t *p) {
+    uint32_t v;
+
+    memcpy(&v, p, 4);
+#if SYS_BYTE_ORDER == BE
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+static inline uint64_t load_le64(const uint8_t *p) {
+    uint64_t v;
+
+    memcpy(&v, p, 8);
+#if SYS_BYTE_ORDER == BE
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static void crc_table_init(crc_table_t t, uint32_t poly)
+{
+    int i, k;
+
+    for (i = 0; i < 256; i++) {
+        uint32_t c = i;
+
+        for (k = 0; k < 8; k++) {
+            c = (c & 1) ? (c >> 1) ^ poly : c >> 1;
+        }
+        t[0][i] = c;
+    }
+
+    for (i = 0; i < 256; i++) {
+        for (k = 1; k < 8; k++) {
+            t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+        }
+    }
+}
+
+// Eight bytes are looked up in eight tables at a time
+static uint32_t crc_slice8(crc_table_t t, uint32_t crc, const uint8_t *p, int len)
+{
+    crc = ~crc;
+
+    for (; len >= 8; p += 8, len -= 8) {
+        uint32_t lo = load_le32(p) ^ crc;
+        uint32_t hi = load_le32(p + 4);
+
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+
+    while (len-- > 0) {
+        crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+#if CRC32C_HW
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, int len)
+{
+    uint64_t c = ~crc;
+
+    for (; len >= 8; p += 8, len -= 8) {
+        c = __builtin_ia32_crc32di(c, load_le64(p));
+    }
+
+    while (len-- > 0) {
+        c = __builtin_ia32_crc32qi((uint32_t) c, *p++);
+    }
+
+    return ~(uint32_t) c;
+}
+
+static int crc32c_hw_present(void)
+{
+    static int present = -1;
+
+    if (present < 0) {
+        __builtin_cpu_init();
+        present = __builtin_cpu_supports("sse4.2") ? 1 : 0;
+    }
+    return present;
+}
+#endif
+
+uint32_t checksum_crc32(uint32_t crc, const void *data, int len)
+{
+    if (!crc32_table[0][1]) {
+        crc_table_init(crc32_table, CRC32_POLY);
+    }
+    return crc_slice8(crc32_table, crc, data, len);
+}
+
+uint32_t checksum_crc32c(uint32_t crc, const void *data, int len)
+{
+#if CRC32C_HW
+    if (crc32c_hw_present()) {
+        return crc32c_hw(crc, data, len);
+    }
+#endif
+    if (!crc32c_table[0][1]) {
+        crc_table_init(crc32c_table, CRC32C_POLY);
+    }
+    return crc_slice8(crc32c_table, crc, data, len);
+}
+
+uint32_t checksum_adler32(uint32_t adler, const void *data, int len)
+{
+    const uint8_t *p = data;
+    uint32_t a = adler & 0xffff, b = adler >> 16;
+
+    while (len > 0) {
+        int n = len < ADLER_NMAX ? len : ADLER_NMAX;
+
+        len -= n;
+        while (n-- > 0) {
+            a += *p++;
+            b += a;
+        }
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+    }
+
+    return (b << 16) | a;
+}
+
+uint32_t checksum_fnv1a(uint32_t hash, const void *data, int len)
+{
+    const uint8_t *p = data;
+
+    while (len-- > 0) {
+        hash ^= *p++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static inline uint64_t xxh_rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    return xxh_rotl(acc + input * XXH_P2, 31) * XXH_P1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t v) {
+    return (acc ^ xxh_round(0, v)) * XXH_P1 + XXH_P4;
+}
+
+uint64_t checksum_xxhash64(uint64_t seed, const void *data, int len)
+{
+    const uint8_t *p = data, *end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        uint64_t v1 = seed + XXH_P1 + XXH_P2;
+        uint64_t v2 = seed + XXH_P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_P1;
+
+        for (; p + 32 <= end; p += 32) {
+            v1 = xxh_round(v1, load_le64(p));
+            v2 = xxh_round(v2, load_le64(p + 8));
+            v3 = xxh_round(v3, load_le64(p + 16));
+            v4 = xxh_round(v4, load_le64(p + 24));
+        }
+
+        h = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) + xxh_rotl(v3, 12) + xxh_rotl(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    } else {
+        h = seed + XXH_P5;
+    }
+
+    h += (uint64_t) len;
+
+    for (; p + 8 <= end; p += 8) {
+        h = xxh_rotl(h ^ xxh_round(0, load_le64(p)), 27) * XXH_P1 + XXH_P4;
+    }
+    if (p + 4 <= end) {
+        h = xxh_rotl(h ^ (load_le32(p) * XXH_P1), 23) * XXH_P2 + XXH_P3;
+        p += 4;
+    }
+    while (p < end) {
+        h = xxh_rotl(h ^ (*p++ * XXH_P5), 11) * XXH_P1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_P2;
+    h ^= h >> 29;
+    h *= XXH_P3;
+    h ^= h >> 32;
+
+    return h;
+}
@@ -0,0 +1,45 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __LANG_CHECKSUM_INC__
+#define __LANG_CHECKSUM_INC__
+
+#include "config.h"
+
+/*
+ * Checksums and hashes of bytes, the first parameter is the result of
+ * previous bytes, to continue the calculation.
+ * crc32 & crc32c are slicing-by-8, crc32c uses SSE4.2 instruction if present.
+ */
+#define CHECKSUM_CRC32_INIT     (0)
+#define CHECKSUM_ADLER32_INIT   (1)
+#define CHECKSUM_FNV1A_INIT     (2166136261u)
+
+uint32_t checksum_crc32(uint32_t crc, const void *data, int len);
+uint32_t checksum_crc32c(uint32_t crc, const void *data, int len);
+uint32_t checksum_adler32(uint32_t adler, const void *data, int len);
+uint32_t checksum_fnv1a(uint32_t hash, const void *data, int len);
+uint64_t checksum_xxhash64(uint64_t seed, const void *data, int len);
+
+#endif /* __LANG_CHECKSUM_INC__ */
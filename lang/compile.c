@@ -74,7 +74,12 @@ static void heap_sort(intptr_t *buf, int num)
 static inline
 intptr_t compile_sym_add(compile_t *cpl, const char *sym)
 {
-    return env_symbal_add(cpl->env, sym);
+    intptr_t id = env_symbal_add(cpl->env, sym);
+
+    if (!id && !cpl->error) {
+        cpl->error = ERR_ResourceOutLimit;
+    }
+    return id;
 }
 
 static inline
@@ -595,6 +600,19 @@ static inline void compile_code_append_call(compile_t *cpl, int ac)
     func->code_buf[func->code_num++] = ac;
 }
 
+static inline void compile_code_append_concat(compile_t *cpl, int n)
+{
+    compile_func_t *func;
+
+    if (cpl->error || 0 > compile_code_check_extend(cpl, 2)) {
+        return;
+    }
+
+    func = compile_func_cur(cpl);
+    func->code_buf[func->code_num++] = BC_CONCAT;
+    func->code_buf[func->code_num++] = n;
+}
+
 static void compile_expr(compile_t *cpl, expr_t *e);
 
 static void compile_code_set_jmp(compile_t *cpl, int pos, uint8_t jmp, int step)
@@ -704,6 +722,42 @@ static void compile_expr_binary(compile_t *cpl, expr_t *e, uint8_t code)
     compile_code_append(cpl, code);
 }
 
+// Operands of left associated '+' chain, in order. Return the number of them.
+static int compile_expr_concat_operands(compile_t *cpl, expr_t *e, int max)
+{
+    int n = 1;
+
+    if (e->type == EXPR_ADD && max > 1) {
+        n += compile_expr_concat_operands(cpl, ast_expr_lft(e), max - 1);
+        compile_expr(cpl, ast_expr_rht(e));
+    } else {
+        compile_expr(cpl, e);
+    }
+    return n;
+}
+
+/*
+ * '+' chain start with string literal, be concatenated at once:
+ * "a" + b + c + d => PUSH_STR a, b, c, d, CONCAT 4
+ */
+static void compile_expr_add(compile_t *cpl, expr_t *e)
+{
+    expr_t *first = ast_expr_lft(e);
+    int n = 2;
+
+    while (first->type == EXPR_ADD) {
+        first = ast_expr_lft(first);
+        n++;
+    }
+
+    if (n > 2 && first->type == EXPR_STRING) {
+        n = compile_expr_concat_operands(cpl, e, LIMIT_CONCAT_SIZE);
+        compile_code_append_concat(cpl, n);
+    } else {
+        compile_expr_binary(cpl, e, BC_ADD);
+    }
+}
+
 static void compile_expr_logic_and(compile_t *cpl, expr_t *e)
 {
     int pos;
@@ -1065,7 +1119,7 @@ static void compile_expr(compile_t *cpl, expr_t *e)
     case EXPR_MUL:      compile_expr_binary(cpl, e, BC_MUL); break;
     case EXPR_DIV:      compile_expr_binary(cpl, e, BC_DIV); break;
     case EXPR_MOD:      compile_expr_binary(cpl, e, BC_MOD); break;
-    case EXPR_ADD:      compile_expr_binary(cpl, e, BC_ADD); break;
+    case EXPR_ADD:      compile_expr_add(cpl, e); break;
     case EXPR_SUB:      compile_expr_binary(cpl, e, BC_SUB); break;
 
     case EXPR_AND:      compile_expr_binary(cpl, e, BC_AAND); break;
@@ -1248,6 +1302,83 @@ static void compile_stmt_while(compile_t *cpl, stmt_t *s)
     compile_code_set_jmp(cpl, skip, BC_JMP, block);
 }
 
+/****************************************************************
+ *                        Iteration form
+ *
+ *              +------------+
+ *              |  iterable  |
+ *              | PUSH_ZERO  |
+ *              | SJMP 3     | ------------+
+ * skip:        + ---------- + <-----------|----+
+ *         +--- |   JMP to   |             |    |
+ *         |    |  LoopEnd   |             |    |
+ *         |    |  (3 BYTE)  |             |    |
+ * Begin:  |    + ---------- + <-----------+----|----+
+ *         +--- | FOR_xx var | -- no more       |    |
+ *         |    |  (4 BYTE)  |                  |    |
+ *         |    + ---------- +                  |    |
+ *         |    | statements | -- break --------+    |
+ *         |    |            | -- continue ----------+
+ *         |    + ---------- +                       |
+ *         |    | JMP Begin  | ----------------------+
+ * LoopEnd +--> +------------+
+ *              |  POP POP   |
+ *              +------------+
+ * The iterable and the index of next item live on stack while looping
+ ***************************************************************/
+static void compile_stmt_for(compile_t *cpl, stmt_t *s, uint8_t op)
+{
+    int id, bgn, skip, end, bgn_bk, skip_bk;
+    uint8_t code[2] = {BC_SJMP, 3};
+    uint8_t *buf;
+
+    // loop variable is always owned by current function
+    id = compile_varmap_find_add(cpl, compile_sym_add(cpl, ast_expr_text(ast_expr_lft(s->expr))));
+    if (id < 0 || id > 255) {
+        cpl->error = cpl->error ? cpl->error : ERR_ResourceOutLimit;
+        return;
+    }
+
+    compile_expr(cpl, ast_expr_rht(s->expr));
+    compile_code_append(cpl, BC_PUSH_ZERO);
+    compile_code_appends(cpl, 2, code);
+
+    skip = compile_code_pos(cpl);
+    compile_code_extend(cpl, 3);
+
+    bgn = compile_code_pos(cpl);
+    compile_code_extend(cpl, 4);
+
+    bgn_bk = cpl->bgn_pos; skip_bk = cpl->skip_pos;
+    cpl->bgn_pos = bgn;    cpl->skip_pos = skip;
+
+    compile_stmt_block(cpl, s->block); if (cpl->error) return;
+
+    cpl->bgn_pos = bgn_bk;
+    cpl->skip_pos = skip_bk;
+
+    end = compile_code_pos(cpl);
+    compile_code_append_jmp(cpl, BC_JMP, -(end - bgn + 3));
+    if (cpl->error) {
+        return;
+    }
+
+    end = compile_code_pos(cpl);
+    compile_code_set_jmp(cpl, skip, BC_JMP, end - (skip + 3));
+
+    buf = compile_code_buf(cpl) + bgn;
+    buf[0] = op;
+    buf[1] = id;
+    buf[2] = (end - (bgn + 4)) >> 8;
+    buf[3] = (end - (bgn + 4));
+    if (end - (bgn + 4) > 32767) {
+        cpl->error = ERR_ResourceOutLimit;
+    }
+
+    compile_code_append(cpl, BC_POP);
+    compile_code_append(cpl, BC_POP);
+}
+
 static void compile_stmt_break(compile_t *cpl, stmt_t *s)
 {
     int bgn, end, total;
@@ -1367,6 +1498,8 @@ int compile_stmt(compile_t *cpl, stmt_t *stmt)
     case STMT_VAR:  compile_stmt_var(cpl, stmt); break;
     case STMT_IF:   compile_stmt_cond(cpl, stmt); break;
     case STMT_WHILE:    compile_stmt_while(cpl, stmt); break;
+    case STMT_FOR_IN:   compile_stmt_for(cpl, stmt, BC_FOR_IN); break;
+    case STMT_FOR_OF:   compile_stmt_for(cpl, stmt, BC_FOR_OF); break;
     case STMT_BREAK:    compile_stmt_break(cpl, stmt); break;
     case STMT_CONTINUE: compile_stmt_continue(cpl, stmt); break;
     case STMT_RET:  compile_stmt_return(cpl, stmt); break;
@@ -1534,6 +1667,12 @@ static int compile_code_revise(compile_t *cpl, compile_func_t *fn)
                             break;
         case BC_FUNC_CALL:  compile_func_stack_pop(cpl, fn);
                             break;
+        case BC_FOR_IN:     break;
+        case BC_FOR_OF:     break;
+        case BC_CONCAT:     while (--p1 > 0) {
+                                compile_func_stack_pop(cpl, fn);
+                            }
+                            break;
         case BC_PROP:       compile_func_stack_pop(cpl, fn);
                             break;
         case BC_PROP_METH:  compile_func_stack_pop(cpl, fn);
@@ -1610,6 +1749,123 @@ int compile_update(compile_t *cpl)
     return 0;
 }
 
+static void compile_heap_move(compile_t *cpl, void *base, int size)
+{
+    intptr_t delta = (intptr_t)base - (intptr_t)cpl->heap.base;
+    int i;
+
+    if (delta) {
+        memmove(base, cpl->heap.base, cpl->heap.free);
+
+        cpl->func_buf = (compile_func_t *)((intptr_t)cpl->func_buf + delta);
+        for (i = 0; i < cpl->func_num; i++) {
+            compile_func_t *fn = cpl->func_buf + i;
+
+            if (fn->var_map)
+                fn->var_map = (intptr_t *)((intptr_t)fn->var_map + delta);
+            if (fn->code_buf)
+                fn->code_buf = (uint8_t *)((intptr_t)fn->code_buf + delta);
+        }
+    }
+
+    cpl->heap.base = base;
+    cpl->heap.size = size;
+}
+
+/*
+ * Move the script functions of a finished top level statement into executable,
+ * only the main function is kept in compile heap.
+ */
+static int compile_func_flush(compile_t *cpl)
+{
+    executable_t *exe = &cpl->env->exe;
+    int i, err = 0;
+
+    for (i = 1; err == 0 && i < cpl->func_num; i++) {
+        compile_func_t *cfp = cpl->func_buf + i;
+
+        compile_code_revise(cpl, cfp);
+        err = executable_func_add(exe, cfp->code_buf, cfp->code_num,
+                                       cfp->var_num, cfp->arg_num,
+                                       cfp->stack_high, cfp->closure);
+    }
+
+    cpl->error = err;
+    if (err) {
+        return -1;
+    }
+
+    cpl->func_num = 1;
+    cpl->func_offset = exe->func_num - 1;
+    compile_gc(cpl);
+
+    return 0;
+}
+
+/*
+ * Parse & compile the input statement by statement, the AST of a statement
+ * is dropped once it compiled. Memory is shared as:
+ *
+ *  parsing:    | AST ->               | compile heap |
+ *  compiling:  | AST | compile heap ->               |
+ *
+ * return: number of statement compiled, or -error
+ */
+int compile_stream(compile_t *cpl, env_t *env, parser_t *psr)
+{
+    uint8_t *mem = psr->heap.base;
+    int size = psr->heap.size;
+    int last = STMT_PASS;
+    int cnt = 0;
+
+    executable_main_reserve(&env->exe);
+    if (0 != compile_init(cpl, env, mem, size)) {
+        return -cpl->error;
+    }
+
+    while (!psr->error && !parse_match(psr, 0)) {
+        stmt_t *s;
+        int top, bot;
+
+        while (parse_match(psr, ';'));
+
+        top = (size - cpl->heap.free) & ~0x07;
+        compile_heap_move(cpl, mem + top, size - top);
+        heap_init(&psr->heap, mem, top);
+
+        if (!(s = parse_stmt(psr))) {
+            return psr->error ? -psr->error : 0;
+        }
+
+        bot = SIZE_ALIGN(psr->heap.free);
+        compile_heap_move(cpl, mem + bot, size - bot);
+
+        if (last == STMT_EXPR) {
+            compile_code_append(cpl, BC_POP);
+        }
+        if (compile_stmt(cpl, s) || compile_func_flush(cpl)) {
+            return -cpl->error;
+        }
+        last = s->type;
+        cnt++;
+    }
+
+    if (psr->error) {
+        return -psr->error;
+    }
+
+    if (cnt == 0) {
+        return 0;
+    }
+
+    compile_code_append(cpl, BC_STOP);
+    if (compile_save_main_vmap(cpl) || compile_update(cpl)) {
+        return -cpl->error;
+    }
+
+    return cnt;
+}
+
 #if 0
 #warning debug function
 void compile_code_dump(compile_t *cpl)
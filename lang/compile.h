@@ -29,6 +29,7 @@ SOFTWARE.
 #include "config.h"
 
 #include "ast.h"
+#include "parse.h"
 #include "env.h"
 #include "interp.h"
 
@@ -79,6 +80,7 @@ int compile_one_stmt(compile_t *cpl, stmt_t *stmt);
 int compile_multi_stmt(compile_t *cpl, stmt_t *stmt);
 
 int compile_update(compile_t *cpl);
+int compile_stream(compile_t *cpl, env_t *env, parser_t *psr);
 
 int compile_env_init(env_t *env, void *mem_ptr, int mem_size);
 int compile_exe(env_t *env, const char *input, void *mem_ptr, int mem_size);
@@ -80,8 +80,12 @@ SOFTWARE.
 # define LIMIT_VMAP_SIZE            (32)    // max variable number in function
 # define LIMIT_FUNC_SIZE            (32767) // max function number in  module
 # define LIMIT_FUNC_CODE_SIZE       (32767) // max code of each function
+# define LIMIT_CONCAT_SIZE          (16)    // max operands of one concatenation
+# define LIMIT_ELEM_SIZE            (0x1000000) // max elements of one array
 
 # define DEF_STRING_SIZE            (8)
+# define DEF_SYMBAL_TBL_SIZE        (16)    // symbal hash table initial size, power of 2
+# define DEF_INTERN_TBL_SIZE        (32)    // initial size of interned string table, power of 2
 
 // lang compile resource default and limit
 
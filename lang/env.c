@@ -23,14 +23,18 @@ SOFTWARE.
 */
 
 #include "env.h"
+#include "hash.h"
 #include "gc.h"
 #include "type_object.h"
 #include "type_string.h"
 #include "type_array.h"
 #include "type_function.h"
+#include "type_buffer.h"
+#include "bcode.h"
 
 #define VACATED     (-1)
 #define FRAME_SIZE  (sizeof(frame_t) / sizeof(val_t))
+#define INTERN_TBL_MAX  (0x8000)    // size of intern table is 16 bits
 
 typedef struct frame_t {
     int fp;
@@ -84,28 +88,14 @@ static void env_heap_gc_init(env_t *env)
     }
 }
 
-static uint32_t hash_pjw(const void *key)
-{
-    const char *ptr = key;
-    uint32_t val = 0;
-
-    while (*ptr) {
-        uint32_t tmp;
-
-        val = (val << 4) + *ptr;
-        tmp = val & 0xf0000000;
-        if (tmp) {
-            val = (val ^ (tmp >> 24)) ^ tmp;
-        }
+#define SYMBAL_ENTRY_SIZE   (sizeof(intptr_t) + sizeof(uint32_t))
+#define SYMBAL_HEAD_SIZE    (2)
+#define SYMBAL_BUF_MAX      (0xFFF8)
+#define SYMBAL_UNMARK       (0xFFFF)
 
-        ptr++;
-    }
-
-    return val;
-}
-
-static inline uint32_t htbl_key(uint32_t size, uint32_t hash, int i) {
-    return (hash + i * (hash * 2 + 1)) % size;
+// Symbal hashes are saved beside the symbal table
+static inline uint32_t *env_symbal_htbl(env_t *env) {
+    return (uint32_t *)(env->symbal_tbl + env->symbal_tbl_size);
 }
 
 static inline char *env_symbal_buf_alloc(env_t *env, int size)
@@ -118,82 +108,343 @@ static inline char *env_symbal_buf_alloc(env_t *env, int size)
     return NULL;
 }
 
+/*
+ * Symbal in buffer: | head(2) | string ... | 0 |
+ * The head is used as mark & forward address by symbal gc.
+ */
 static char *env_symbal_put(env_t *env, const char *str)
 {
     int size = strlen(str) + 1;
-    char *sym = env_symbal_buf_alloc(env, size);
+    char *sym = env_symbal_buf_alloc(env, SYMBAL_HEAD_SIZE + size);
 
     if (sym) {
+        sym[0] = sym[1] = 0;
+        sym += SYMBAL_HEAD_SIZE;
         memcpy(sym, str, size);
     }
     return sym;
 }
 
-static int env_symbal_lookup(env_t *env, const char *symbal, char **res)
-{
-    uint32_t size, pos, i, hash;
-    intptr_t *tbl = env->symbal_tbl;
+static inline int env_symbal_is_owned(env_t *env, intptr_t s) {
+    return s > (intptr_t)env->symbal_buf && s < (intptr_t)(env->symbal_buf + env->symbal_buf_used);
+}
+
+static inline int symbal_head_get(const char *s) {
+    const uint8_t *head = (const uint8_t *)s - SYMBAL_HEAD_SIZE;
+    return head[0] * 0x100 + head[1];
+}
 
+static inline void symbal_head_set(char *s, int v) {
+    uint8_t *head = (uint8_t *)s - SYMBAL_HEAD_SIZE;
+    head[0] = v >> 8;
+    head[1] = v;
+}
 
-    if (env->symbal_tbl_hold == 0) {
-        return 0;
+/*
+ * Symbal table sit on the top of symbal buffer, string of symbal is allocated from bottom.
+ * A bigger table is built under the old one, and moved to the top when rehash done.
+ */
+static int env_symbal_tbl_resize(env_t *env, int size)
+{
+    int bytes = size * SYMBAL_ENTRY_SIZE;
+    int end = env->symbal_buf_end + env->symbal_tbl_size * SYMBAL_ENTRY_SIZE;
+    intptr_t *old_tbl = env->symbal_tbl;
+    uint32_t *old_htbl = env_symbal_htbl(env);
+    uint32_t mask = size - 1;
+    intptr_t *tbl;
+    uint32_t *htbl;
+    int i, hold = 0;
+
+    if (env->symbal_buf_used + bytes > env->symbal_buf_end) {
+        return -1;
     }
 
-    size = env->symbal_tbl_size;
-    hash = hash_pjw(symbal);
+    tbl = (intptr_t *)(env->symbal_buf + env->symbal_buf_end - bytes);
+    htbl = (uint32_t *)(tbl + size);
+    memset(tbl, 0, bytes);
 
-    for (i = 0; i < size; i++) {
-        pos = htbl_key(size, hash, i);
+    for (i = 0; i < env->symbal_tbl_size; i++) {
+        uint32_t pos;
 
-        if (tbl[pos] == 0) {
-            break;
+        if (old_tbl[i] == 0 || old_tbl[i] == VACATED) {
+            continue;
         }
-        if ((intptr_t)symbal == tbl[pos] || !strcmp(symbal, (char*)tbl[pos])) {
-            if (res) *res = (char *)tbl[pos];
-            return 1;
+
+        pos = old_htbl[i] & mask;
+        while (tbl[pos]) {
+            pos = (pos + 1) & mask;
         }
+        tbl[pos] = old_tbl[i];
+        htbl[pos] = old_htbl[i];
+        hold++;
     }
 
+    memmove(env->symbal_buf + end - bytes, tbl, bytes);
+    env->symbal_tbl = (intptr_t *)(env->symbal_buf + end - bytes);
+    env->symbal_tbl_size = size;
+    env->symbal_tbl_hold = hold;
+    env->symbal_buf_end = end - bytes;
+
     return 0;
 }
 
-intptr_t env_symbal_insert(env_t *env, const char *symbal, int alloc)
+/*
+ * Rehash in place, vacated slots are cleaned.
+ * Start from an empty slot, no probe sequence cross it, so every symbal is
+ * moved to a slot in [home, current], which has been rehashed already.
+ */
+static void env_symbal_tbl_rehash(env_t *env)
 {
-    uint32_t size, pos, i, hash;
     intptr_t *tbl = env->symbal_tbl;
-    char *p;
+    uint32_t *htbl = env_symbal_htbl(env);
+    uint32_t mask = env->symbal_tbl_size - 1;
+    uint32_t start, i;
+    int hold = 0;
+
+    // At least one slot is empty, see env_symbal_insert_try
+    for (start = 0; tbl[start]; start++)
+        ;
+
+    for (i = 0; i < env->symbal_tbl_size; i++) {
+        if (tbl[i] == VACATED) {
+            tbl[i] = 0;
+        }
+    }
 
-    if (env_symbal_lookup(env, symbal, &p) == 1) {
-        return (intptr_t)p;
+    for (i = 1; i < env->symbal_tbl_size; i++) {
+        uint32_t cur = (start + i) & mask;
+        uint32_t pos;
+        intptr_t sym = tbl[cur];
+
+        if (!sym) {
+            continue;
+        }
+
+        tbl[cur] = 0;
+        pos = htbl[cur] & mask;
+        while (tbl[pos]) {
+            pos = (pos + 1) & mask;
+        }
+        tbl[pos] = sym;
+        htbl[pos] = htbl[cur];
+        hold++;
     }
+    env->symbal_tbl_hold = hold;
+}
 
-    size = env->symbal_tbl_size;
-    if (env->symbal_tbl_hold >= size) {
-        env_set_error(env, ERR_ResourceOutLimit);
+static intptr_t env_symbal_lookup(env_t *env, const char *symbal, uint32_t hash)
+{
+    intptr_t *tbl = env->symbal_tbl;
+    uint32_t *htbl = env_symbal_htbl(env);
+    uint32_t mask = env->symbal_tbl_size - 1;
+    uint32_t pos = hash & mask;
+
+    if (env->symbal_tbl_hold == 0) {
         return 0;
     }
 
-    hash = hash_pjw(symbal);
-    for (i = 0; i < size; i++) {
-        pos = htbl_key(size, hash, i);
-
-        if (tbl[pos] == 0 || tbl[pos] == VACATED) {
-            p = alloc ? env_symbal_put(env, symbal) : (char *)symbal;
-            tbl[pos] = (intptr_t)p;
-            env->symbal_tbl_hold++;
-            return (intptr_t)p;
+    while (tbl[pos]) {
+        if (htbl[pos] == hash && tbl[pos] != VACATED &&
+            ((intptr_t)symbal == tbl[pos] || !strcmp(symbal, (char*)tbl[pos]))) {
+            return tbl[pos];
         }
+        pos = (pos + 1) & mask;
     }
 
     return 0;
 }
 
-intptr_t env_symbal_get(env_t *env, const char *name) {
+// Return 0 without error set, if no space left
+static intptr_t env_symbal_insert_try(env_t *env, const char *symbal, int alloc)
+{
+    uint32_t hash = hash_fnv1a(symbal);
+    uint32_t mask, pos;
+    intptr_t *tbl;
     char *p;
-    if (1 == env_symbal_lookup(env, name, &p)) {
+
+    if (0 != (p = (char *)env_symbal_lookup(env, symbal, hash))) {
         return (intptr_t)p;
     }
-    return 0;
+
+    // Keep load factor under 3/4, at least one slot should be empty
+    if ((env->symbal_tbl_hold + 1) * 4 > env->symbal_tbl_size * 3) {
+        if (0 != env_symbal_tbl_resize(env, env->symbal_tbl_size * 2) &&
+            env->symbal_tbl_hold + 1 >= env->symbal_tbl_size) {
+            return 0;
+        }
+    }
+
+    p = alloc ? env_symbal_put(env, symbal) : (char *)symbal;
+    if (!p) {
+        return 0;
+    }
+
+    tbl = env->symbal_tbl;
+    mask = env->symbal_tbl_size - 1;
+    pos = hash & mask;
+    while (tbl[pos] && tbl[pos] != VACATED) {
+        pos = (pos + 1) & mask;
+    }
+
+    if (tbl[pos] == 0) {
+        env->symbal_tbl_hold++;
+    }
+    tbl[pos] = (intptr_t)p;
+    env_symbal_htbl(env)[pos] = hash;
+
+    return (intptr_t)p;
+}
+
+intptr_t env_symbal_insert(env_t *env, const char *symbal, int alloc)
+{
+    intptr_t sym = env_symbal_insert_try(env, symbal, alloc);
+
+    if (!sym) {
+        env_set_error(env, ERR_ResourceOutLimit);
+    }
+    return sym;
+}
+
+/*
+ * Add symbal at running time, the unused symbals are collected if no space left.
+ * Note: name may be moved by gc, it should be a val on stack.
+ * Symbals held by the caller are moved too, only the referenced ones are kept.
+ */
+intptr_t env_symbal_add_dynamic(env_t *env, val_t *name)
+{
+    intptr_t sym = env_symbal_insert_try(env, val_2_cstring(name), 1);
+
+    if (!sym) {
+        env_heap_gc(env, 0);
+        sym = env_symbal_insert(env, val_2_cstring(name), 1);
+    }
+    return sym;
+}
+
+static void env_symbal_mark(void *ud, intptr_t *ref)
+{
+    env_t *env = ud;
+
+    if (env_symbal_is_owned(env, *ref)) {
+        symbal_head_set((char *)*ref, 0);
+    }
+}
+
+static void env_symbal_forward(void *ud, intptr_t *ref)
+{
+    env_t *env = ud;
+
+    if (env_symbal_is_owned(env, *ref)) {
+        *ref = (intptr_t)env->symbal_buf + symbal_head_get((char *)*ref);
+    }
+}
+
+static void env_symbal_walk(env_t *env, heap_t *heap, void (*cb)(void *, intptr_t *))
+{
+    executable_t *exe = &env->exe;
+    int i, fp, sp;
+
+    for (i = 0; i < exe->string_num; i++) {
+        cb(env, exe->string_map + i);
+    }
+
+    for (i = 0; i < env->main_var_num; i++) {
+        cb(env, env->main_var_map + i);
+    }
+
+    if (env->ref_num && env->ref_ent) {
+        gc_symbal_walk_vals(env->ref_num, env->ref_ent, cb, env);
+    }
+
+    fp = env->fp, sp = env->sp;
+    while (1) {
+        gc_symbal_walk_vals(fp - sp, env->sb + sp, cb, env);
+        if (fp == env->ss) {
+            break;
+        } else {
+            frame_t *frame = (frame_t *)(env->sb + fp);
+
+            fp = frame->fp;
+            sp = frame->sp;
+        }
+    }
+
+    gc_symbal_walk(heap, cb, env);
+}
+
+/*
+ * Symbal gc: mark symbals referenced by code, variable map & values,
+ * then compact the symbal buffer and update the references.
+ * Should be called after heap gc, heap is the new one.
+ */
+static void env_symbal_gc(env_t *env, heap_t *heap)
+{
+    char *buf = env->symbal_buf;
+    int end = env->symbal_buf_used;
+    int off, pos, i;
+
+    for (off = 0; off < end; off += SYMBAL_HEAD_SIZE + strlen(buf + off + SYMBAL_HEAD_SIZE) + 1) {
+        symbal_head_set(buf + off + SYMBAL_HEAD_SIZE, SYMBAL_UNMARK);
+    }
+
+    env_symbal_walk(env, heap, env_symbal_mark);
+
+    // Compute forward address
+    for (off = 0, pos = 0; off < end;) {
+        char *s = buf + off + SYMBAL_HEAD_SIZE;
+        int size = SYMBAL_HEAD_SIZE + strlen(s) + 1;
+
+        if (symbal_head_get(s) != SYMBAL_UNMARK) {
+            symbal_head_set(s, pos + SYMBAL_HEAD_SIZE);
+            pos += size;
+        }
+        off += size;
+    }
+
+    if (pos == end) {
+        return;
+    }
+
+    // Update references
+    env_symbal_walk(env, heap, env_symbal_forward);
+    for (i = 0; i < env->symbal_tbl_size; i++) {
+        intptr_t s = env->symbal_tbl[i];
+
+        if (env_symbal_is_owned(env, s)) {
+            if (symbal_head_get((char *)s) == SYMBAL_UNMARK) {
+                env->symbal_tbl[i] = VACATED;
+            } else {
+                env->symbal_tbl[i] = (intptr_t)buf + symbal_head_get((char *)s);
+            }
+        }
+    }
+    executable_string_reindex(&env->exe);
+
+    // Compact
+    for (off = 0; off < end;) {
+        char *s = buf + off + SYMBAL_HEAD_SIZE;
+        int size = SYMBAL_HEAD_SIZE + strlen(s) + 1;
+        int head = symbal_head_get(s);
+
+        if (head != SYMBAL_UNMARK) {
+            memmove(buf + head - SYMBAL_HEAD_SIZE, s - SYMBAL_HEAD_SIZE, size);
+            symbal_head_set(buf + head, 0);
+        }
+        off += size;
+    }
+    env->symbal_buf_used = pos;
+
+    // Rehash to clean vacated slots
+    env_symbal_tbl_rehash(env);
+}
+
+intptr_t env_symbal_get(env_t *env, const char *name) {
+    return env_symbal_lookup(env, name, hash_fnv1a(name));
+}
+
+// The hash is known, e.g. cached by string
+intptr_t env_symbal_get_hashed(env_t *env, const char *name, uint32_t hash) {
+    return env_symbal_lookup(env, name, hash);
 }
 
 int env_exe_memery_distribute(int size, int *num_max, int *str_max, int *fn_max, int *code_max)
@@ -213,9 +464,10 @@ int env_exe_memery_distribute(int size, int *num_max, int *str_max, int *fn_max,
     }
 
     if (str_max) {
-        // 7/16 of memory as function entry space
-        str_space = size * 7 / 8;
-        *str_max = str_space / (sizeof(intptr_t) * 2 + DEF_STRING_SIZE);
+        // 13/16 of memory as string entry space
+        str_space = size * 13 / 16;
+        // string entry in executable, and symbal in symbal buffer (table slot & string)
+        *str_max = str_space / (sizeof(intptr_t) * 3 + DEF_STRING_SIZE + EXEC_HASH_ENTRY_SPACE + EXEC_STRING_INFO_SPACE);
         size -= str_space;
     } else {
         str_space = 0;
@@ -224,7 +476,7 @@ int env_exe_memery_distribute(int size, int *num_max, int *str_max, int *fn_max,
     if (num_max) {
         // 1/32 of memory as number
         num_space = SIZE_ALIGN_8(size / 2);
-        *num_max = num_space / sizeof(double);
+        *num_max = num_space / (sizeof(double) + EXEC_HASH_ENTRY_SPACE);
         size -= num_space;
     } else {
         num_space = 0;
@@ -254,7 +506,7 @@ int env_init(env_t *env, void *mem_ptr, int mem_size,
              int code_max, int interactive)
 {
     int mem_offset;
-    int exe_size, symbal_tbl_size;
+    int exe_size, symbal_size;
 
     env->error = 0;
 
@@ -297,6 +549,12 @@ int env_init(env_t *env, void *mem_ptr, int mem_size,
     }
     env->main_var_num = 0;
 
+    // intern table init, allocated from heap as needed
+    env->intern_tbl = NULL;
+    env->intern_tbl_size = 0;
+    env->intern_tbl_hold = 0;
+    env->extern_list = NULL;
+
     // native init
     env->native_num = 0;
     env->native_ent = NULL;
@@ -313,20 +571,23 @@ int env_init(env_t *env, void *mem_ptr, int mem_size,
     }
     mem_offset += exe_size;
 
-    symbal_tbl_size = string_max * sizeof(intptr_t);
-    if (mem_offset + symbal_tbl_size > mem_size) {
-        return -1;
+    // symbal offsets are 16 bits, the rest of memory is not used
+    symbal_size = mem_size - mem_offset;
+    if (symbal_size > SYMBAL_BUF_MAX) {
+        symbal_size = SYMBAL_BUF_MAX;
     }
-    env->symbal_tbl = (intptr_t *) (mem_ptr + mem_offset);
-    env->symbal_tbl_size = string_max;
-    env->symbal_tbl_hold = 0;
-    memset(mem_ptr + mem_offset, 0, symbal_tbl_size);
-    mem_offset += symbal_tbl_size;
-
     env->symbal_buf = mem_ptr + mem_offset;
-    env->symbal_buf_end = mem_size - mem_offset;
+    env->symbal_buf_end = symbal_size & ~0x07;
     env->symbal_buf_used = 0;
 
+    // symbal table init, grow up as needed
+    env->symbal_tbl = (intptr_t *) (env->symbal_buf + env->symbal_buf_end);
+    env->symbal_tbl_size = 0;
+    env->symbal_tbl_hold = 0;
+    if (0 != env_symbal_tbl_resize(env, DEF_SYMBAL_TBL_SIZE)) {
+        return -1;
+    }
+
 #if 0
     printf("memory total: %d\n", mem_size);
     printf("stack: %d\n", mem_offset - exe_size - heap_size);
@@ -343,6 +604,7 @@ int env_init(env_t *env, void *mem_ptr, int mem_size,
 
     // Initialise callbacks
     env->gc_callback = NULL;
+    memset(env->exe_gc_mark, 0, sizeof(env->exe_gc_mark));
 
     if (0 != objects_env_init(env)) {
         return -1;
@@ -353,16 +615,38 @@ int env_init(env_t *env, void *mem_ptr, int mem_size,
 
 int env_deinit(env_t *env)
 {
-    (void) env;
+    buffer_extern_release_all(env);
     return 0;
 }
 
+// Arguments are copied, the rest variables are undefined
+static void env_scope_fill(scope_t *scope, int vn, int an, int ac, val_t *av)
+{
+    val_t *buf = scope->var_buf;
+    int i, d = ac - an;
+
+    if (d < 0) {
+        for (i = 0; i < ac; i++) {
+            buf[i] = av[i];
+        }
+    } else {
+        for (i = 0; i < an; i++) {
+            buf[i] = av[i];
+        }
+    }
+    for (; i < vn; i++) {
+        val_set_undefined(buf + i);
+    }
+
+    for (i = 0; i < d; i++) {
+        buf[vn + i] = av[an + i];
+    }
+}
+
 scope_t *env_scope_create(env_t *env, scope_t *super, uint8_t *entry, int ac, val_t *av)
 {
     scope_t *scope;
-    val_t   *buf;
-    int vn, an, vc;
-    int i, d;
+    int vn, an, vc, d;
 
     if (entry) {
         vn = executable_func_get_var_cnt(entry);
@@ -379,31 +663,15 @@ scope_t *env_scope_create(env_t *env, scope_t *super, uint8_t *entry, int ac, va
         env_set_error(env, ERR_NotEnoughMemory);
         return NULL;
     }
-    buf = (val_t *) (scope + 1);
-
-    if (d < 0) {
-        for (i = 0; i < ac; i++) {
-            buf[i] = av[i];
-        }
-    } else {
-        for (i = 0; i < an; i++) {
-            buf[i] = av[i];
-        }
-    }
-    for (; i < vn; i++) {
-        val_set_undefined(buf + i);
-    }
-
-    for (i = 0; i < d; i++) {
-        buf[vn + i] = av[an + i];
-    }
 
     scope->magic = MAGIC_SCOPE;
     scope->age = 0;
     scope->num = vc;
     scope->nao = vn;
     scope->super = super;
-    scope->var_buf = buf;
+    scope->var_buf = (val_t *) (scope + 1);
+
+    env_scope_fill(scope, vn, an, ac, av);
 
     return scope;
 }
@@ -455,6 +723,88 @@ const uint8_t *env_frame_setup(env_t *env, const uint8_t *pc, val_t *fv, int ac,
     return function_code(fn);
 }
 
+/*
+ * Hold a frame for the callee called repeatedly by native, see interp_callback_prepare.
+ * The current scope is saved in it, ac slots of arguments are reserved under it.
+ * Return the frame offset, or -1 if the stack overflow.
+ */
+int env_frame_hold(env_t *env, int ac)
+{
+    int fp = env->sp - FRAME_SIZE;
+    frame_t *frame;
+
+    if (fp - ac < 0) {
+        env->error = ERR_StackOverflow;
+        return -1;
+    }
+
+    frame = (frame_t *)(env->sb + fp);
+    frame->fp = env->fp;
+    frame->sp = env->sp;
+    frame->pc = 0;
+    frame->scope = (intptr_t) env->scope;
+
+    env->fp = fp;
+    env->sp = fp - ac;
+
+    return fp;
+}
+
+// Drop the held frame, and the frames over it left by error
+void env_frame_unhold(env_t *env, int fp)
+{
+    frame_t *frame = (frame_t *)(env->sb + fp);
+
+    env->sp = frame->sp;
+    env->fp = frame->fp;
+    env->scope = (scope_t *) frame->scope;
+}
+
+/*
+ * As env_frame_setup, but arguments are kept in the slots of held frame.
+ * reuse: 0, a new scope for each call;
+ *        1, a new scope kept as the current one after return;
+ *        2, the current one (kept by last call) is reloaded with arguments.
+ */
+const uint8_t *env_frame_reenter(env_t *env, const uint8_t *pc, val_t *fv, int ac, val_t *av, int reuse)
+{
+    function_t *fn = (function_t *)val_2_intptr(fv);
+    scope_t *scope;
+    frame_t *frame;
+    int fp;
+
+    if (reuse > 1) {
+        scope = env->scope;
+        env_scope_fill(scope, scope->nao, function_argc(fn), ac, av);
+    } else {
+        if (NULL == (scope = env_scope_create(env, fn->super, fn->entry, ac, av))) {
+            return NULL;
+        }
+        if (!env_is_valid_ptr(env, fn)) {
+            fn = (function_t *)val_2_intptr(fv); // fv had update, by gc
+            scope->super = fn->super;
+        }
+    }
+
+    fp = env->sp - FRAME_SIZE;
+    if (fp < 0 || fp < function_stack_high(fn)) {
+        env->error = ERR_StackOverflow;
+        return NULL;
+    }
+
+    frame = (frame_t *)(env->sb + fp);
+    frame->fp = env->fp;
+    frame->sp = env->sp;
+    frame->pc = (intptr_t) pc;
+    frame->scope = (intptr_t) (reuse ? scope : env->scope);
+
+    env->fp = fp;
+    env->sp = fp;
+    env->scope = scope;
+
+    return function_code(fn);
+}
+
 void env_frame_restore(env_t *env, const uint8_t **pc, scope_t **scope)
 {
     if (env->fp != env->ss) {
@@ -473,11 +823,18 @@ void env_frame_restore(env_t *env, const uint8_t **pc, scope_t **scope)
 void env_native_call(env_t *env, val_t *fv, int ac, val_t *av)
 {
     function_native_t fn = (function_native_t) val_2_intptr(fv);
-    int sp;
+    int sp, i;
 
     sp = env->sp + ac; // skip arguments & keep return value in stack
 
-    *(env->sb + sp) = fn(env, ac, av);
+    // native expect contiguous string
+    for (i = 0; i < ac; i++) {
+        if (val_is_heap_string(av + i) && !string_flatten(env, av + i)) {
+            break;
+        }
+    }
+
+    *(env->sb + sp) = i < ac ? val_mk_undefined() : fn(env, ac, av);
 
     env->sp = sp;
 }
@@ -516,15 +873,216 @@ void *env_heap_alloc(env_t *env, int size)
     return ptr;
 }
 
-void env_heap_gc(env_t *env, int flags)
+/*
+ * Intern table is kept in the bytes of a heap buffer, which is not referred by
+ * any value: it's dropped by gc, and a new one is built by env_intern_gc.
+ */
+static intptr_t *env_intern_tbl_alloc(heap_t *heap, int size)
 {
-    heap_t *free_heap = env_heap_get_free(env);
+    int len = sizeof(intptr_t) * size;
+    type_buffer_t *b = heap_alloc(heap, buffer_mem_space_of(len));
 
-    (void) flags;
+    if (!b) {
+        return NULL;
+    }
+
+    b->magic = MAGIC_BUFFER;
+    b->age = 0;
+    b->len = len;
+    memset(b->buf, 0, len);
+
+    return (intptr_t *) b->buf;
+}
+
+static void env_intern_tbl_insert(intptr_t *tbl, uint32_t mask, string_t *s)
+{
+    uint32_t pos;
+
+    for (pos = s->hash & mask; tbl[pos]; pos = (pos + 1) & mask)
+        ;
+    tbl[pos] = (intptr_t) s;
+}
+
+// Double the intern table, not gc here: s to be interned may be moved
+static int env_intern_tbl_grow(env_t *env)
+{
+    int size = env->intern_tbl_size ? env->intern_tbl_size * 2 : DEF_INTERN_TBL_SIZE;
+    intptr_t *tbl;
+    int i;
+
+    if (size > INTERN_TBL_MAX) {
+        return -1;
+    }
+
+    tbl = env_intern_tbl_alloc(env->heap, size);
+    if (!tbl) {
+        return -1;
+    }
+
+    for (i = 0; i < env->intern_tbl_size; i++) {
+        if (env->intern_tbl[i]) {
+            env_intern_tbl_insert(tbl, size - 1, (string_t *) env->intern_tbl[i]);
+        }
+    }
+    env->intern_tbl = tbl;
+    env->intern_tbl_size = size;
+
+    return 0;
+}
+
+static inline int env_intern_tbl_full(env_t *env)
+{
+    return (env->intern_tbl_hold + 1) * 4 > env->intern_tbl_size * 3;
+}
+
+/*
+ * Find the interned string with the same bytes of v, v is interned if none.
+ * The hash of v should be computed, return 0 if the table can not grow up.
+ * v should be reachable by gc, it may be moved when the table grows up.
+ */
+intptr_t env_string_intern(env_t *env, val_t *v)
+{
+    string_t *str = (string_t *) val_2_intptr(v);
+    intptr_t *tbl = env->intern_tbl;
+    uint32_t mask = env->intern_tbl_size - 1;
+    uint32_t pos;
+
+    for (pos = str->hash & mask; tbl && tbl[pos]; pos = (pos + 1) & mask) {
+        string_t *in = (string_t *) tbl[pos];
+
+        if (in == str || (in->hash == str->hash && in->len == str->len &&
+                          !memcmp(in->str, str->str, str->len))) {
+            return (intptr_t) in;
+        }
+    }
+
+    if (env_intern_tbl_full(env) && env_intern_tbl_grow(env)) {
+        // table rebuilt by gc has free slots, if any memory
+        env_heap_gc(env, sizeof(intptr_t) * DEF_INTERN_TBL_SIZE);
+        str = (string_t *) val_2_intptr(v);
+        if (env_intern_tbl_full(env) && env_intern_tbl_grow(env)) {
+            return 0;
+        }
+    }
+
+    env_intern_tbl_insert(env->intern_tbl, env->intern_tbl_size - 1, str);
+    str->interned = 1;
+    env->intern_tbl_hold++;
+
+    return (intptr_t) str;
+}
+
+// Make sure that size bytes could be allocated later, without GC
+int env_heap_reserve(env_t *env, int size)
+{
+    if (heap_free_size(env->heap) <= size) {
+        env_heap_gc(env, size);
+    }
+    return heap_free_size(env->heap) > size;
+}
+
+/*
+ * Interned strings are weak referenced:
+ * the moved ones are forwarded into a new table, the others are not reached and dropped.
+ * The new table is sized by the living ones, it shrinks as well as grows.
+ */
+static void env_intern_gc(env_t *env, heap_t *heap, int need)
+{
+    intptr_t *old = env->intern_tbl;
+    intptr_t *tbl = NULL;
+    int i, hold = 0, size = DEF_INTERN_TBL_SIZE;
+
+    for (i = 0; i < env->intern_tbl_size; i++) {
+        string_t *s = (string_t *) old[i];
+
+        if (s) {
+            if (s->magic == MAGIC_STRING) {
+                old[i] = 0;
+            } else {
+                old[i] = *((intptr_t *) s);
+                hold++;
+            }
+        }
+    }
+
+    while (hold * 2 > size && size < INTERN_TBL_MAX) {
+        size *= 2;
+    }
+    // keep need bytes for the caller of gc: give up the spare slots, then the table
+    for (; hold; size /= 2) {
+        if (heap_free_size(heap) - buffer_mem_space_of(sizeof(intptr_t) * size) > need) {
+            tbl = env_intern_tbl_alloc(heap, size);
+        }
+        if (tbl || size == DEF_INTERN_TBL_SIZE || hold * 4 >= size / 2 * 3) {
+            break;
+        }
+    }
+
+    for (i = 0; i < env->intern_tbl_size; i++) {
+        string_t *s = (string_t *) old[i];
+
+        if (!s) {
+            continue;
+        }
+        if (tbl) {
+            env_intern_tbl_insert(tbl, size - 1, s);
+        } else {
+            // no memory for table, keep them as normal strings
+            s->interned = 0;
+        }
+    }
+
+    env->intern_tbl = tbl;
+    env->intern_tbl_size = tbl ? size : 0;
+    env->intern_tbl_hold = tbl ? hold : 0;
+}
+
+// External buffers not moved by gc are dead, release them
+static void env_extern_gc(env_t *env)
+{
+    type_buffer_extern_t *b = env->extern_list, *next, *live = NULL;
+
+    for (; b; b = next) {
+        next = b->next;
+        if (b->magic == MAGIC_BUFFER_EXTERN) {
+            if (b->release) {
+                b->release(b->data, b->len);
+            }
+        } else {
+            type_buffer_extern_t *dup = (type_buffer_extern_t *) *((intptr_t *) b);
+
+            dup->next = live;
+            live = dup;
+        }
+    }
+
+    env->extern_list = live;
+}
+
+/*
+ * Collect the heap, size is the bytes wanted by the caller after gc, 0 if none.
+ * Symbals are compacted only if no bytes wanted: symbal or its cstring kept
+ * in C locals across an allocation is not moved, nor dropped.
+ */
+void env_heap_gc(env_t *env, int size)
+{
+    heap_t *free_heap = env_heap_get_free(env);
 
     env_heap_gc_init(env);
     gc_scan(free_heap);
 
+    if (!size && env->symbal_buf_used) {
+        env_symbal_gc(env, free_heap);
+    }
+
+    if (env->intern_tbl) {
+        env_intern_gc(env, free_heap, size);
+    }
+
+    if (env->extern_list) {
+        env_extern_gc(env);
+    }
+
     if (env->gc_callback) {
         env->gc_callback();
     }
@@ -532,6 +1090,280 @@ void env_heap_gc(env_t *env, int flags)
     env->heap = free_heap;
 }
 
+typedef struct exe_gc_t {
+    executable_t *exe;
+    uint16_t *fn_ids;
+    uint16_t *num_ids;
+    uint16_t *str_ids;
+    uint8_t **fn_entries;
+} exe_gc_t;
+
+// Script functions are added from the top of code: entry address decrease as id increase
+static int env_exe_func_id(executable_t *exe, uint8_t *entry)
+{
+    int lo = 1, hi = exe->func_num - 1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+
+        if (exe->func_map[mid] == entry) {
+            return mid;
+        } else
+        if (exe->func_map[mid] > entry) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    return 0;
+}
+
+static void env_exe_mark_function(void *ud, function_t *fn)
+{
+    exe_gc_t *gc = ud;
+    int id = env_exe_func_id(gc->exe, fn->entry);
+
+    if (id && !gc->fn_ids[id]) {
+        gc->fn_ids[id] = 1;
+    }
+}
+
+static void env_exe_update_function(void *ud, function_t *fn)
+{
+    exe_gc_t *gc = ud;
+    int id = env_exe_func_id(gc->exe, fn->entry);
+
+    if (id) {
+        fn->entry = gc->fn_entries[id];
+    }
+}
+
+static inline int code_get_u16(uint8_t *code) {
+    return code[0] * 0x100 + code[1];
+}
+
+static inline void code_set_u16(uint8_t *code, int v) {
+    code[0] = v >> 8;
+    code[1] = v;
+}
+
+/*
+ * Visit the operands of function, number & string reference in code of function.
+ * When update is set, operands are replaced by new id,
+ * otherwise mark the reference.
+ */
+static void env_exe_scan_code(exe_gc_t *gc, int id, int update)
+{
+    uint8_t *entry = gc->exe->func_map[id];
+    uint8_t *code = (uint8_t *)executable_func_get_code(entry);
+    int end = executable_func_get_code_size(entry);
+    int off = 0;
+
+    while (off < end) {
+        const char *name;
+        int p1, p2, cp = off;
+        uint16_t *ids;
+
+        bcode_parse(code, &off, &name, &p1, &p2);
+        if (off <= cp) {
+            break;
+        }
+
+        switch (code[cp]) {
+        case BC_PUSH_SCRIPT:ids = gc->fn_ids; break;
+        case BC_PUSH_NUM:   ids = gc->num_ids; break;
+        case BC_PUSH_STR:   ids = gc->str_ids; break;
+        default:            continue;
+        }
+
+        p1 = code_get_u16(code + cp + 1);
+        if (update) {
+            // function id is mapping to new id directly, constant is mapping to new index + 1
+            code_set_u16(code + cp + 1, ids == gc->fn_ids ? ids[p1] : ids[p1] - 1);
+        } else
+        if (!ids[p1]) {
+            ids[p1] = 1;
+        }
+    }
+}
+
+/*
+ * Used & size of areas reclaimed by exe gc: code, function, number, string and symbal.
+ */
+static void env_exe_gc_usage(env_t *env, int *used, int *size)
+{
+    executable_t *exe = &env->exe;
+    int top;
+
+    if (exe->func_num > 1) {
+        top = exe->func_map[1] - exe->code + FUNC_HEAD_SIZE + executable_func_get_code_size(exe->func_map[1]);
+    } else {
+        top = exe->func_code_end;
+    }
+
+    used[0] = top - exe->func_code_end;
+    size[0] = top;
+    used[1] = exe->func_num;
+    size[1] = exe->func_max;
+    used[2] = exe->number_num;
+    size[2] = exe->number_max;
+    used[3] = exe->string_num;
+    size[3] = exe->string_max;
+    used[4] = env->symbal_buf_used;
+    size[4] = env->symbal_buf_end;
+}
+
+/*
+ * An area is pressed if 3/4 of it is used, and half of the space left by
+ * last exe gc is used since then: no gc again and again, if nothing could
+ * be reclaimed.
+ */
+static int env_exe_gc_pressed(env_t *env)
+{
+    int used[EXE_GC_AREA_NUM], size[EXE_GC_AREA_NUM];
+    int i;
+
+    env_exe_gc_usage(env, used, size);
+    for (i = 0; i < EXE_GC_AREA_NUM; i++) {
+        int mark = env->exe_gc_mark[i];
+
+        if (used[i] * 4 >= size[i] * 3 && (used[i] - mark) * 2 >= size[i] - mark) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Reclaim script functions and constants, which could not be reached from
+ * living function objects.
+ *
+ * Only work at top level of interactive mode, where old main code is useless
+ * and no frame holds a code address.
+ */
+int env_exe_gc(env_t *env, int force)
+{
+    executable_t *exe = &env->exe;
+    heap_t *scratch;
+    exe_gc_t gc;
+    int size[EXE_GC_AREA_NUM];
+    int i, n, top, end, space;
+
+    if (!env_is_interactive(env) || env->fp != env->ss) {
+        return 0;
+    }
+
+    if (!force && !env_exe_gc_pressed(env)) {
+        return 0;
+    }
+
+    env_heap_gc(env, 0);
+
+    // Functions are kept on the top of code space, constants may be reclaimed without function
+    if (exe->func_num > 1) {
+        top = exe->func_map[1] - exe->code + FUNC_HEAD_SIZE + executable_func_get_code_size(exe->func_map[1]);
+    } else {
+        top = exe->func_code_end;
+    }
+
+    scratch = env_heap_get_free(env);
+    space = sizeof(uint8_t *) * exe->func_num + sizeof(uint16_t) * (exe->func_num + exe->number_num + exe->string_num);
+    if (space > scratch->size) {
+        return -1;
+    }
+    gc.exe = exe;
+    gc.fn_entries = (uint8_t **) scratch->base;
+    gc.fn_ids  = (uint16_t *) (gc.fn_entries + exe->func_num);
+    gc.num_ids = gc.fn_ids + exe->func_num;
+    gc.str_ids = gc.num_ids + exe->number_num;
+    memset(gc.fn_ids, 0, sizeof(uint16_t) * (exe->func_num + exe->number_num + exe->string_num));
+
+    // Mark: 1 means marked, 2 means code scanned
+    gc_function_walk(env->heap, env_exe_mark_function, &gc);
+    do {
+        n = 0;
+        for (i = 1; i < exe->func_num; i++) {
+            if (gc.fn_ids[i] == 1) {
+                env_exe_scan_code(&gc, i, 0);
+                gc.fn_ids[i] = 2;
+                n++;
+            }
+        }
+    } while (n);
+
+    // Compute new id & new address
+    for (i = 1, n = 1, end = top; i < exe->func_num; i++) {
+        if (gc.fn_ids[i]) {
+            uint8_t *entry = exe->func_map[i];
+
+            end -= FUNC_HEAD_SIZE + executable_func_get_code_size(entry);
+            gc.fn_entries[i] = exe->code + end;
+            gc.fn_ids[i] = n++;
+        }
+    }
+    for (i = 0, n = 0; i < exe->number_num; i++) {
+        if (gc.num_ids[i]) {
+            gc.num_ids[i] = ++n;
+        }
+    }
+    for (i = 0, n = 0; i < exe->string_num; i++) {
+        if (gc.str_ids[i]) {
+            gc.str_ids[i] = ++n;
+        }
+    }
+
+    // Update references
+    for (i = 1; i < exe->func_num; i++) {
+        if (gc.fn_ids[i]) {
+            env_exe_scan_code(&gc, i, 1);
+        }
+    }
+    gc_function_walk(env->heap, env_exe_update_function, &gc);
+
+    // Compact code, move to top in id order
+    for (i = 1, n = 1; i < exe->func_num; i++) {
+        if (gc.fn_ids[i]) {
+            uint8_t *entry = exe->func_map[i];
+
+            memmove(gc.fn_entries[i], entry, FUNC_HEAD_SIZE + executable_func_get_code_size(entry));
+            exe->func_map[n++] = gc.fn_entries[i];
+        }
+    }
+    exe->func_num = n;
+    exe->func_code_end = end;
+    exe->main_code_end = 0;
+    exe->func_map[0] = exe->code;
+
+    // Compact constants
+    for (i = 0, n = 0; i < exe->number_num; i++) {
+        if (gc.num_ids[i]) {
+            exe->number_map[n++] = exe->number_map[i];
+        }
+    }
+    exe->number_num = n;
+    for (i = 0, n = 0; i < exe->string_num; i++) {
+        if (gc.str_ids[i]) {
+            exe->string_lens[n] = exe->string_lens[i];
+            exe->string_hashes[n] = exe->string_hashes[i];
+            exe->string_map[n++] = exe->string_map[i];
+        }
+    }
+    exe->string_num = n;
+
+    executable_number_reindex(exe);
+    executable_string_reindex(exe);
+
+    // Symbals of dropped string constants were marked by heap gc, collect them now
+    if (env->symbal_buf_used) {
+        env_symbal_gc(env, env->heap);
+    }
+
+    env_exe_gc_usage(env, env->exe_gc_mark, size);
+
+    return 0;
+}
+
 int env_number_find_add(env_t *env, double n)
 {
     return executable_number_find_add(&env->exe, n);
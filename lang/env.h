@@ -36,6 +36,8 @@ SOFTWARE.
 
 struct native_t;
 
+#define EXE_GC_AREA_NUM     5           // code, function, number, string & symbal
+
 typedef struct env_t {
     int16_t error;
     int16_t main_var_num;
@@ -66,8 +68,16 @@ typedef struct env_t {
 
     intptr_t *main_var_map;
 
+    uint16_t intern_tbl_size;           // Intern table size
+    uint16_t intern_tbl_hold;           // Interned string counter
+    intptr_t *intern_tbl;               // Weak table of interned heap string
+
+    struct type_buffer_extern_t *extern_list;   // Weak list of external buffer
+
     void (*gc_callback)(void);
 
+    int exe_gc_mark[EXE_GC_AREA_NUM];   // Used of exe areas after last exe gc
+
     executable_t exe;
 } env_t;
 
@@ -89,14 +99,18 @@ int env_callback_set(env_t *env, void (*cb)(void));
 int env_native_set(env_t *env, const native_t *ent, int num);
 
 void *env_heap_alloc(env_t *env, int size);
-void env_heap_gc(env_t *env, int level);
+int env_heap_reserve(env_t *env, int size);
+void env_heap_gc(env_t *env, int size);
+int  env_exe_gc(env_t *env, int force);
 
 scope_t *env_scope_create(env_t *env, scope_t *super, uint8_t *entry, int ac, val_t *av);
 int env_scope_get(env_t *env, int id, val_t **v);
 int env_scope_set(env_t *env, int id, val_t *v);
 
 intptr_t env_symbal_insert(env_t *env, const char *symbal, int alloc);
+intptr_t env_symbal_add_dynamic(env_t *env, val_t *name);
 intptr_t env_symbal_get(env_t *env, const char *name);
+intptr_t env_symbal_get_hashed(env_t *env, const char *name, uint32_t hash);
 static inline
 intptr_t env_symbal_add(env_t *env, const char *name) {
     return env_symbal_insert(env, name, 1);
@@ -108,6 +122,7 @@ intptr_t env_symbal_add_static(env_t *env, const char *name) {
 void env_symbal_foreach(env_t *env, int (*cb)(const char *, void *), void *param);
 
 int env_string_find_add(env_t *env, intptr_t s);
+intptr_t env_string_intern(env_t *env, val_t *v);
 int env_number_find_add(env_t *env, double);
 
 int env_native_find(env_t *env, intptr_t sym_id);
@@ -115,6 +130,9 @@ int env_native_find(env_t *env, intptr_t sym_id);
 const uint8_t *env_frame_setup(env_t *env, const uint8_t *pc, val_t *fv, int ac, val_t *av);
 const uint8_t *env_func_entry_setup(env_t *env, uint8_t *entry, int ac, val_t *av);
 void env_frame_restore(env_t *env, const uint8_t **pc, scope_t **scope);
+int  env_frame_hold(env_t *env, int ac);
+void env_frame_unhold(env_t *env, int fp);
+const uint8_t *env_frame_reenter(env_t *env, const uint8_t *pc, val_t *fv, int ac, val_t *av, int reuse);
 void env_native_call(env_t *env, val_t *fv, int ac, val_t *av);
 
 const uint8_t *env_main_entry_setup(env_t *env, int ac, val_t *av);
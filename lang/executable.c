@@ -23,13 +23,52 @@ SOFTWARE.
 */
 
 #include "err.h"
+#include "hash.h"
 #include "executable.h"
 #include "type_function.h"
 
+// Hash table size: power of 2 and great than max, keep one empty slot at least
+static int executable_hash_size(int max)
+{
+    int size = 2;
+
+    if (max <= 0) {
+        return 0;
+    }
+
+    while (size <= max) {
+        size <<= 1;
+    }
+
+    return size;
+}
+
+static inline uint32_t executable_number_hash(double n)
+{
+    uint64_t bits;
+
+    memcpy(&bits, &n, sizeof(bits));
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+
+    return (uint32_t) bits;
+}
+
+static inline uint32_t executable_string_hash(intptr_t s)
+{
+    uint64_t bits = (uint64_t) s;
+
+    bits = (bits >> 3) * 0x9e3779b97f4a7c15ULL;
+
+    return (uint32_t) (bits >> 32);
+}
+
 int executable_init(executable_t *exe, void *mem_ptr, int mem_size,
                     int number_max, int string_max, int func_max, int code_max)
 {
     int mem_offset = 0;
+    int size;
 
     exe->code = (uint8_t*) (mem_ptr + mem_offset);
     exe->main_code_end = 0;
@@ -55,25 +94,54 @@ int executable_init(executable_t *exe, void *mem_ptr, int mem_size,
     exe->func_map = (uint8_t **) (mem_ptr + mem_offset);
     mem_offset += sizeof(uint8_t **) * func_max;
 
+    // static string length & hash
+    exe->string_hashes = (uint32_t *) (mem_ptr + mem_offset);
+    mem_offset += sizeof(uint32_t) * string_max;
+    exe->string_lens = (uint16_t *) (mem_ptr + mem_offset);
+    mem_offset += sizeof(uint16_t) * string_max;
+
+    // static number & string hash index init
+    size = executable_hash_size(number_max);
+    exe->number_hash_mask = size - 1;
+    exe->number_hash = (uint16_t *) (mem_ptr + mem_offset);
+    mem_offset += sizeof(uint16_t) * size;
+
+    size = executable_hash_size(string_max);
+    exe->string_hash_mask = size - 1;
+    exe->string_hash = (uint16_t *) (mem_ptr + mem_offset);
+    mem_offset += sizeof(uint16_t) * size;
+    mem_offset = SIZE_ALIGN_8(mem_offset);
+
     if (mem_offset > mem_size) {
         return -1;
     } else {
+        memset(exe->number_hash, 0, sizeof(uint16_t) * executable_hash_size(number_max));
+        memset(exe->string_hash, 0, sizeof(uint16_t) * executable_hash_size(string_max));
         return mem_offset;
     }
 }
 
 int executable_number_find_add(executable_t *exe, double n)
 {
+    uint32_t pos;
     int i;
 
-    for (i = 0; i < exe->number_num; i++) {
-        if (exe->number_map[i] == n) {
-            return i;
+    if (exe->number_max == 0) {
+        return -1;
+    }
+
+    pos = executable_number_hash(n) & exe->number_hash_mask;
+    while (0 != (i = exe->number_hash[pos])) {
+        if (exe->number_map[i - 1] == n) {
+            return i - 1;
         }
+        pos = (pos + 1) & exe->number_hash_mask;
     }
 
     if (exe->number_num < exe->number_max) {
-        exe->number_map[exe->number_num++] = n;
+        i = exe->number_num++;
+        exe->number_map[i] = n;
+        exe->number_hash[pos] = i + 1;
         return i;
     } else {
         return -1;
@@ -82,26 +150,93 @@ int executable_number_find_add(executable_t *exe, double n)
 
 int executable_string_find_add(executable_t *exe, intptr_t s)
 {
+    uint32_t pos;
     int i;
 
-    if (s == 0) {
+    if (s == 0 || exe->string_max == 0) {
         return -1;
     }
 
-    for (i = 0; i < exe->string_num; i++) {
-        if (exe->string_map[i] == s) {
-            return i;
+    pos = executable_string_hash(s) & exe->string_hash_mask;
+    while (0 != (i = exe->string_hash[pos])) {
+        if (exe->string_map[i - 1] == s) {
+            return i - 1;
         }
+        pos = (pos + 1) & exe->string_hash_mask;
     }
 
     if (exe->string_num < exe->string_max) {
-        exe->string_map[exe->string_num++] = s;
+        i = exe->string_num++;
+        exe->string_map[i] = s;
+        exe->string_hash[pos] = i + 1;
+        exe->string_lens[i] = strlen((const char *)s);
+        exe->string_hashes[i] = hash_fnv1a((const char *)s);
         return i;
     } else {
         return -1;
     }
 }
 
+int executable_string_find(executable_t *exe, intptr_t s)
+{
+    uint32_t pos;
+    int i;
+
+    if (exe->string_num == 0) {
+        return -1;
+    }
+
+    pos = executable_string_hash(s) & exe->string_hash_mask;
+    while (0 != (i = exe->string_hash[pos])) {
+        if (exe->string_map[i - 1] == s) {
+            return i - 1;
+        }
+        pos = (pos + 1) & exe->string_hash_mask;
+    }
+
+    return -1;
+}
+
+// Rebuild number hash index, after number_map compacted
+void executable_number_reindex(executable_t *exe)
+{
+    int i;
+
+    if (exe->number_max == 0) {
+        return;
+    }
+
+    memset(exe->number_hash, 0, sizeof(uint16_t) * (exe->number_hash_mask + 1));
+    for (i = 0; i < exe->number_num; i++) {
+        uint32_t pos = executable_number_hash(exe->number_map[i]) & exe->number_hash_mask;
+
+        while (exe->number_hash[pos]) {
+            pos = (pos + 1) & exe->number_hash_mask;
+        }
+        exe->number_hash[pos] = i + 1;
+    }
+}
+
+// Rebuild string hash index, after string_map changed
+void executable_string_reindex(executable_t *exe)
+{
+    int i;
+
+    if (exe->string_max == 0) {
+        return;
+    }
+
+    memset(exe->string_hash, 0, sizeof(uint16_t) * (exe->string_hash_mask + 1));
+    for (i = 0; i < exe->string_num; i++) {
+        uint32_t pos = executable_string_hash(exe->string_map[i]) & exe->string_hash_mask;
+
+        while (exe->string_hash[pos]) {
+            pos = (pos + 1) & exe->string_hash_mask;
+        }
+        exe->string_hash[pos] = i + 1;
+    }
+}
+
 int executable_func_set_head(void *buf, uint8_t vc, uint8_t ac, uint32_t code_size, uint16_t stack_size, int closure) {
     uint8_t *head = (uint8_t *)buf;
     int mark = 0;
@@ -50,6 +50,16 @@ typedef struct executable_t {
     intptr_t *string_map;
     uint8_t **func_map;
 
+    // Length & hash of string constants, beside string_map
+    uint32_t *string_hashes;
+    uint16_t *string_lens;
+
+    // Hash index of number_map & string_map: slot hold (index + 1), 0 means empty
+    uint32_t  number_hash_mask;
+    uint32_t  string_hash_mask;
+    uint16_t *number_hash;
+    uint16_t *string_hash;
+
     uint32_t  main_code_end;
     uint32_t  func_code_end;
 
@@ -73,6 +83,11 @@ typedef struct image_info_t {
 } image_info_t;
 
 
+// Bytes per pool entry used by hash index, at worst
+#define EXEC_HASH_ENTRY_SPACE   (sizeof(uint16_t) * 2)
+// Bytes per string entry used by length & hash
+#define EXEC_STRING_INFO_SPACE  (sizeof(uint16_t) + sizeof(uint32_t))
+
 int executable_init(executable_t *exe, void *memory, int size,
                     int number_max, int string_max, int func_max, int code_max);
 
@@ -82,6 +97,16 @@ void executable_main_clr(executable_t *exe)
     exe->main_code_end = 0;
 }
 
+// Hold entry 0 for main code, script functions can be added before it
+static inline
+void executable_main_reserve(executable_t *exe)
+{
+    if (exe->func_num == 0) {
+        exe->func_map[0] = exe->code + exe->main_code_end;
+        exe->func_num = 1;
+    }
+}
+
 int executable_func_set_head(void *buf, uint8_t vc, uint8_t ac, uint32_t code_size, uint16_t stack_size, int closure);
 int executable_func_get_head(void *buf, uint8_t *vc, uint8_t *ac, uint32_t *code_size, uint16_t *stack_size, int *closure);
 int executable_main_add(executable_t *exe, void *code, uint16_t size, uint8_t vc, uint8_t ac, uint16_t stack_size, int closure);
@@ -119,6 +144,9 @@ int executable_func_is_closure(const uint8_t *entry) {
 
 int executable_number_find_add(executable_t *exe, double n);
 int executable_string_find_add(executable_t *exe, intptr_t s);
+int executable_string_find(executable_t *exe, intptr_t s);
+void executable_number_reindex(executable_t *exe);
+void executable_string_reindex(executable_t *exe);
 
 int image_init(image_info_t *img, void *mem_ptr, int mem_size, int byte_order, int nc, int sc, int fc);
 int image_load(image_info_t *img, uint8_t *input, int size);
@@ -22,6 +22,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <stdlib.h>
+
 #include "val.h"
 #include "heap.h"
 #include "gc.h"
@@ -30,6 +32,8 @@ SOFTWARE.
 #include "type_array.h"
 #include "type_object.h"
 #include "type_buffer.h"
+#include "type_builder.h"
+#include "type_view.h"
 
 #define MAGIC_BYTE(x) (*((uint8_t *)(x)))
 #define ADDR_VALUE(x) (*((void **)(x)))
@@ -88,6 +92,8 @@ static array_t *heap_dup_array(heap_t *heap, array_t *a)
     memcpy(dup, a, sizeof(array_t));
     memcpy(vals, array_values(a), sizeof(val_t) * array_len(a));
     dup->elems = vals;
+    dup->elem_bgn = 0;
+    dup->elem_end = array_len(a);
 
     ADDR_VALUE(a) = dup;
 
@@ -108,9 +114,29 @@ static intptr_t heap_dup_string(heap_t *heap, intptr_t str)
     return (intptr_t) dup;
 }
 
+static intptr_t heap_dup_rope(heap_t *heap, val_rope_t *rope)
+{
+    void *dup = heap_alloc(heap, string_mem_space_rope());
+
+    memcpy(dup, rope, sizeof(val_rope_t));
+
+    ADDR_VALUE(rope) = dup;
+    return (intptr_t) dup;
+}
+
+static intptr_t heap_dup_slice(heap_t *heap, val_slice_t *slice)
+{
+    void *dup = heap_alloc(heap, string_mem_space_slice());
+
+    memcpy(dup, slice, sizeof(val_slice_t));
+
+    ADDR_VALUE(slice) = dup;
+    return (intptr_t) dup;
+}
+
 static void *heap_dup_buffer(heap_t *heap, type_buffer_t *buf)
 {
-    int size = buffer_mem_space(buf);
+    int size = buffer_mem_space_head(buf);
     void *dup = heap_alloc(heap, size);
 
     //printf("%s: free %d, %d, %s\n", __func__, heap->free, size, (char *)(str + 3));
@@ -122,6 +148,26 @@ static void *heap_dup_buffer(heap_t *heap, type_buffer_t *buf)
     return dup;
 }
 
+static void *heap_dup_builder(heap_t *heap, type_builder_t *builder)
+{
+    void *dup = heap_alloc(heap, builder_mem_space());
+
+    memcpy(dup, (void*)builder, sizeof(type_builder_t));
+
+    ADDR_VALUE(builder) = dup;
+    return dup;
+}
+
+static void *heap_dup_view(heap_t *heap, type_view_t *view)
+{
+    void *dup = heap_alloc(heap, view_mem_space());
+
+    memcpy(dup, (void*)view, sizeof(type_view_t));
+
+    ADDR_VALUE(view) = dup;
+    return dup;
+}
+
 static intptr_t heap_dup_foreign(heap_t *heap, val_foreign_t *foreign)
 {
     int size = foreign_mem_space(foreign);
@@ -160,12 +206,32 @@ scope_t *gc_copy_scope(heap_t *heap, scope_t *scope)
     return heap_dup_scope(heap, scope);
 }
 
-static inline intptr_t gc_copy_string(heap_t *heap, intptr_t str)
+static intptr_t gc_copy_string(heap_t *heap, intptr_t str)
 {
     if (!str || heap_is_owned(heap, (void*)str)) {
         return (intptr_t) str;
     }
 
+    if (MAGIC_BYTE(str) == MAGIC_STRING_ROPE) {
+        val_rope_t *rope = (val_rope_t *) str;
+
+        // flattened rope, only the flat string is kept
+        if (val_is_undefined(&rope->right)) {
+            return gc_copy_string(heap, val_2_intptr(&rope->left));
+        }
+        return heap_dup_rope(heap, rope);
+    }
+
+    if (MAGIC_BYTE(str) == MAGIC_STRING_SLICE) {
+        val_slice_t *slice = (val_slice_t *) str;
+
+        // slice of the whole heap string, only the string is kept
+        if (slice->off == 0 && slice->len == slice->end && val_is_heap_string(&slice->parent)) {
+            return gc_copy_string(heap, val_2_intptr(&slice->parent));
+        }
+        return heap_dup_slice(heap, slice);
+    }
+
     if (MAGIC_BYTE(str) != MAGIC_STRING) {
         return (intptr_t) ADDR_VALUE(str);
     }
@@ -205,13 +271,40 @@ static inline void *gc_copy_buffer(heap_t *heap, type_buffer_t *buf)
         return buf;
     }
 
-    if (MAGIC_BYTE(buf) != MAGIC_BUFFER) {
+    if (MAGIC_BYTE(buf) != MAGIC_BUFFER && MAGIC_BYTE(buf) != MAGIC_BUFFER_SLICE &&
+        MAGIC_BYTE(buf) != MAGIC_BUFFER_EXTERN) {
         return ADDR_VALUE(buf);
     }
 
     return heap_dup_buffer(heap, buf);
 }
 
+static inline void *gc_copy_builder(heap_t *heap, type_builder_t *builder)
+{
+    if (!builder || heap_is_owned(heap, (void*)builder)) {
+        return builder;
+    }
+
+    if (MAGIC_BYTE(builder) != MAGIC_BUILDER) {
+        return ADDR_VALUE(builder);
+    }
+
+    return heap_dup_builder(heap, builder);
+}
+
+static inline void *gc_copy_view(heap_t *heap, type_view_t *view)
+{
+    if (!view || heap_is_owned(heap, (void*)view)) {
+        return view;
+    }
+
+    if (MAGIC_BYTE(view) != MAGIC_VIEW) {
+        return ADDR_VALUE(view);
+    }
+
+    return heap_dup_view(heap, view);
+}
+
 static inline object_t *gc_copy_object(heap_t *heap, object_t *obj)
 {
     if (!obj || MAGIC_BYTE(obj) == MAGIC_OBJECT_STATIC || heap_is_owned(heap, obj)) {
@@ -260,6 +353,12 @@ void gc_copy_vals(heap_t *heap, int vc, val_t *vp)
         if (val_is_buffer(v)) {
             val_set_buffer(v, gc_copy_buffer(heap, (type_buffer_t *)val_2_intptr(v)));
         } else
+        if (val_is_builder(v)) {
+            val_set_builder(v, gc_copy_builder(heap, (type_builder_t *)val_2_intptr(v)));
+        } else
+        if (val_is_view(v)) {
+            val_set_view(v, gc_copy_view(heap, (type_view_t *)val_2_intptr(v)));
+        } else
         if (val_is_foreign(v)) {
             val_set_foreign(v, (intptr_t)gc_copy_foreign(heap, (val_foreign_t *)val_2_intptr(v)));
         }
@@ -267,29 +366,55 @@ void gc_copy_vals(heap_t *heap, int vc, val_t *vp)
     }
 }
 
+/*
+ * Memory space of the item at p, items are packed one by one in heap after gc.
+ */
+static int gc_mem_space(void *p)
+{
+    switch(MAGIC_BYTE(p)) {
+    case MAGIC_STRING:          return string_mem_space((intptr_t)p);
+    case MAGIC_STRING_ROPE:     return string_mem_space_rope();
+    case MAGIC_STRING_SLICE:    return string_mem_space_slice();
+    case MAGIC_FUNCTION:        return function_mem_space((function_t *)p);
+    case MAGIC_SCOPE:           return scope_mem_space((scope_t *)p);
+    case MAGIC_OBJECT:          return object_mem_space((object_t *)p);
+    case MAGIC_ARRAY:           return array_mem_space((array_t *)p);
+    case MAGIC_BUFFER:          return buffer_mem_space((type_buffer_t *)p);
+    case MAGIC_BUFFER_SLICE:    return buffer_mem_space_slice();
+    case MAGIC_BUFFER_EXTERN:   return buffer_mem_space_extern();
+    case MAGIC_BUILDER:         return builder_mem_space();
+    case MAGIC_VIEW:            return view_mem_space();
+    case MAGIC_FOREIGN:         return foreign_mem_space((val_foreign_t *)p);
+    default:
+        // Unknown item, the heap is broken and can not be walked any more
+        abort();
+    }
+}
+
 void gc_scan(heap_t *heap)
 {
     uint8_t*base = heap->base;
     int     scan = 0;
 
     while(scan < heap->free) {
-        uint8_t magic = base[scan];
+        void *p = base + scan;
 
-        switch(magic) {
-        case MAGIC_STRING:
-            scan += string_mem_space((intptr_t)(base + scan));
+        switch(MAGIC_BYTE(p)) {
+        case MAGIC_STRING_ROPE:
+            gc_copy_vals(heap, 2, &((val_rope_t *)p)->left);
+            break;
+        case MAGIC_STRING_SLICE:
+            gc_copy_vals(heap, 1, &((val_slice_t *)p)->parent);
             break;
         case MAGIC_FUNCTION: {
-            function_t *func = (function_t *)(base + scan);
-            scan += function_mem_space(func);
+            function_t *func = (function_t *)p;
 
             func->super = gc_copy_scope(heap, func->super);
 
             break;
             }
         case MAGIC_SCOPE: {
-            scope_t *scope = (scope_t *) (base + scan);
-            scan += scope_mem_space(scope);
+            scope_t *scope = (scope_t *)p;
 
             scope->super = gc_copy_scope(heap, scope->super);
             gc_copy_vals(heap, scope->num, scope->var_buf);
@@ -297,8 +422,7 @@ void gc_scan(heap_t *heap)
             break;
             }
         case MAGIC_OBJECT: {
-            object_t *obj = (object_t *) (base + scan);
-            scan += object_mem_space(obj);
+            object_t *obj = (object_t *)p;
 
             obj->proto = gc_copy_object(heap, obj->proto);
             gc_copy_vals(heap, obj->prop_num, obj->vals);
@@ -306,21 +430,114 @@ void gc_scan(heap_t *heap)
             break;
             }
         case MAGIC_ARRAY: {
-            array_t *array= (array_t*) (base + scan);
-            scan += array_mem_space(array);
+            array_t *array= (array_t *)p;
 
-            gc_copy_vals(heap, array_len(array), array_values(array));
+            if (!array_is_number_elems(array)) {
+                gc_copy_vals(heap, array_len(array), array_values(array));
+            }
+
+            break;
+            }
+        case MAGIC_BUFFER_SLICE:
+            gc_copy_vals(heap, 1, &((type_buffer_slice_t *)p)->parent);
+            break;
+        case MAGIC_BUILDER:
+            gc_copy_vals(heap, 1, &((type_builder_t *)p)->buf);
+            break;
+        case MAGIC_VIEW:
+            gc_copy_vals(heap, 1, &((type_view_t *)p)->buffer);
+            break;
+        default: break;
+        }
+        scan += gc_mem_space(p);
+    }
+}
+
+
+/*
+ * Visit all symbal references of values: the foreign string.
+ */
+void gc_symbal_walk_vals(int vc, val_t *vp, void (*cb)(void *, intptr_t *), void *ud)
+{
+    int i;
+
+    for (i = 0; i < vc; i++) {
+        val_t *v = vp + i;
+
+        if (val_is_foreign_string(v)) {
+            intptr_t s = val_2_intptr(v);
+
+            cb(ud, &s);
+            val_set_foreign_string(v, s);
+        }
+    }
+}
+
+/*
+ * Visit all symbal references in heap, should only be called on the heap after gc.
+ */
+void gc_symbal_walk(heap_t *heap, void (*cb)(void *, intptr_t *), void *ud)
+{
+    uint8_t*base = heap->base;
+    int     scan = 0;
+    int     i;
+
+    while(scan < heap->free) {
+        void *p = base + scan;
+
+        switch(MAGIC_BYTE(p)) {
+        case MAGIC_STRING_ROPE:
+            gc_symbal_walk_vals(2, &((val_rope_t *)p)->left, cb, ud);
+            break;
+        case MAGIC_STRING_SLICE:
+            gc_symbal_walk_vals(1, &((val_slice_t *)p)->parent, cb, ud);
+            break;
+        case MAGIC_SCOPE: {
+            scope_t *scope = (scope_t *)p;
+
+            gc_symbal_walk_vals(scope->num, scope->var_buf, cb, ud);
 
             break;
             }
-        case MAGIC_BUFFER:
-            scan += buffer_mem_space((type_buffer_t *)(base + scan));
+        case MAGIC_OBJECT: {
+            object_t *obj = (object_t *)p;
+
+            for (i = 0; i < obj->prop_num; i++) {
+                cb(ud, obj->keys + i);
+            }
+            gc_symbal_walk_vals(obj->prop_num, obj->vals, cb, ud);
+
             break;
-        case MAGIC_FOREIGN:
-            scan += foreign_mem_space((val_foreign_t *) (base + scan));
+            }
+        case MAGIC_ARRAY: {
+            array_t *array= (array_t *)p;
+
+            if (!array_is_number_elems(array)) {
+                gc_symbal_walk_vals(array_len(array), array_values(array), cb, ud);
+            }
+
             break;
+            }
         default: break;
         }
+        scan += gc_mem_space(p);
     }
 }
 
+/*
+ * Visit all function objects in heap, should only be called on the heap after gc.
+ */
+void gc_function_walk(heap_t *heap, void (*cb)(void *, function_t *), void *ud)
+{
+    uint8_t*base = heap->base;
+    int     scan = 0;
+
+    while(scan < heap->free) {
+        void *p = base + scan;
+
+        if (MAGIC_BYTE(p) == MAGIC_FUNCTION) {
+            cb(ud, (function_t *)p);
+        }
+        scan += gc_mem_space(p);
+    }
+}
@@ -27,9 +27,15 @@ SOFTWARE.
 
 #include "scope.h"
 
+struct function_t;
+
 scope_t *gc_copy_scope(heap_t *heap, scope_t *scope);
 void gc_copy_vals(heap_t *heap, int vc, val_t *vp);
 void gc_scan(heap_t *heap);
 
+void gc_symbal_walk_vals(int vc, val_t *vp, void (*cb)(void *, intptr_t *), void *ud);
+void gc_symbal_walk(heap_t *heap, void (*cb)(void *, intptr_t *), void *ud);
+void gc_function_walk(heap_t *heap, void (*cb)(void *, struct function_t *), void *ud);
+
 #endif /* __LANG_GC_INC__ */
 
@@ -45,14 +45,16 @@ void heap_clean(heap_t *heap)
 
 void *heap_alloc(heap_t *heap, int size) {
     if (heap) {
-        int free;
+        // compare with rest space, heap->free + size may overflow
+        if (size < 0 || size > heap->size - heap->free) {
+            return NULL;
+        }
 
         size = SIZE_ALIGN(size);
-        free = heap->free + size;
         //printf("Alloc %d, size: %u, free: %u\n", size, heap->size, heap->free);
-        if (free < heap->size) {
+        if (size < heap->size - heap->free) {
             void *p = heap->base + heap->free;
-            heap->free = free;
+            heap->free += size;
             return p;
         }
     }
@@ -93,6 +93,14 @@ void interp_elem_op_self(env_t *env, val_op_unary_t operate) {
     val_t *prop = val_elem_ref(env, obj, key);
     if (prop) {
         operate(env, prop, res);
+    } else
+    if (val_is_view(obj)) {
+        // elements of view are not values, operate on a copy and store it back
+        val_t self = *obj, cur;
+
+        val_op_elem(env, &self, key, &cur);
+        operate(env, &cur, res);
+        val_elem_set(env, &self, key, &cur);
     } else {
         val_set_nan(res);
     }
@@ -105,9 +113,14 @@ static inline void interp_op_set(env_t *env, val_op_t operate) {
     val_t *ref = rht + 1;
     val_t *lft = interp_var_ref(env, ref);
     if (lft) {
-        operate(env, lft, rht, lft);
-        *ref = *lft;
-        env_stack_pop(env);
+        // variable may be moved by GC, operate on a copy in stack
+        val_t *tmp = env_stack_push(env);
+
+        *tmp = *lft;
+        operate(env, tmp, rht, tmp);
+        *interp_var_ref(env, ref) = *tmp;
+        *ref = *tmp;
+        env_stack_release(env, 2);
     } else {
         env_set_error(env, ERR_InvalidLeftValue);
     }
@@ -120,8 +133,17 @@ static inline void interp_prop_op_set(env_t *env, val_op_t operate) {
     val_t *res = obj;
     val_t *prop = val_prop_ref(env, obj, key);
     if (prop) {
-        operate(env, prop, val, prop);
-        *res = *prop;
+        // object may be moved by GC, operate on a copy in stack
+        val_t *tmp = env_stack_push(env);
+
+        *tmp = *prop;
+        operate(env, tmp, val, tmp);
+        prop = val_prop_ref(env, obj, key);
+        if (prop) {
+            *prop = *tmp;
+        }
+        *res = *tmp;
+        env_stack_pop(env);
     } else {
         val_set_nan(res);
     }
@@ -137,8 +159,29 @@ static inline void interp_elem_op_set(env_t *env, val_op_t operate) {
     val_t *res = obj;
     val_t *elem = val_elem_ref(env, obj, key);
     if (elem) {
-        operate(env, elem, val, elem);
-        *res = *elem;
+        // array may be moved by GC, operate on a copy in stack
+        val_t *tmp = env_stack_push(env);
+
+        *tmp = *elem;
+        operate(env, tmp, val, tmp);
+        elem = val_elem_ref(env, obj, key);
+        if (elem) {
+            *elem = *tmp;
+            if (val_is_array(obj)) {
+                array_elem_stored((array_t *)val_2_intptr(obj), elem);
+            }
+        }
+        *res = *tmp;
+        env_stack_pop(env);
+    } else
+    if (val_is_view(obj)) {
+        val_t *cur = env_stack_push(env);
+
+        val_op_elem(env, obj, key, cur);
+        operate(env, cur, val, cur);
+        val_elem_set(env, obj, key, cur);
+        *res = *cur;
+        env_stack_pop(env);
     } else {
         val_set_nan(res);
     }
@@ -158,43 +201,57 @@ static inline void interp_logic_not(env_t *env) {
     val_set_boolean(v, !val_is_true(v));
 }
 
+// Ropes to be compared should be flattened, before operands poped (defence GC)
+static inline val_t *interp_compare_operands(env_t *env) {
+    val_t *b = env_stack_peek(env);
+
+    if (string_is_rope(b)) {
+        string_flatten(env, b);
+    }
+    if (string_is_rope(b + 1)) {
+        string_flatten(env, b + 1);
+    }
+
+    return env_stack_pop(env);
+}
+
 static inline void interp_teq(env_t *env) {
-    val_t *b = env_stack_pop(env);
+    val_t *b = interp_compare_operands(env);
     val_t *a = b + 1;
 
     val_set_boolean(a, val_is_equal(a, b));
 }
 
 static inline void interp_tne(env_t *env) {
-    val_t *b = env_stack_pop(env);
+    val_t *b = interp_compare_operands(env);
     val_t *a = b + 1;
 
     val_set_boolean(a, !val_is_equal(a, b));
 }
 
 static inline void interp_tgt(env_t *env) {
-    val_t *op2 = env_stack_pop(env);
+    val_t *op2 = interp_compare_operands(env);
     val_t *op1 = op2 + 1;
 
     val_set_boolean(op1, val_is_gt(op1, op2));
 }
 
 static inline void interp_tge(env_t *env) {
-    val_t *op2 = env_stack_pop(env);
+    val_t *op2 = interp_compare_operands(env);
     val_t *op1 = op2 + 1;
 
     val_set_boolean(op1, val_is_ge(op1, op2));
 }
 
 static inline void interp_tlt(env_t *env) {
-    val_t *op2 = env_stack_pop(env);
+    val_t *op2 = interp_compare_operands(env);
     val_t *op1 = op2 + 1;
 
     val_set_boolean(op1, val_is_lt(op1, op2));
 }
 
 static inline void interp_tle(env_t *env) {
-    val_t *op2 = env_stack_pop(env);
+    val_t *op2 = interp_compare_operands(env);
     val_t *op1 = op2 + 1;
 
     val_set_boolean(op1, val_is_le(op1, op2));
@@ -249,6 +306,75 @@ static inline void interp_dict(env_t *env, int n) {
     }
 }
 
+/*
+ * Strings and numbers are joined at once, if one of the first two operands is string,
+ * (two leading numbers are summed), otherwise operands are added one by one.
+ */
+static inline void interp_concat(env_t *env, int n) {
+    val_t *av = env_stack_peek(env);
+    val_t *res = av + n - 1;
+    int i;
+
+    for (i = 0; i < n && (val_is_string(av + i) || val_is_number(av + i)); i++)
+        ;
+
+    if (i == n && (val_is_string(av + n - 1) || val_is_string(av + n - 2))) {
+        string_concat(env, n, av, res);
+    } else {
+        for (i = n - 2; i >= 0; i--) {
+            val_op_add(env, res, av + i, res);
+        }
+    }
+
+    env_stack_release(env, n - 1);
+}
+
+/*
+ * Stack: index, iterable. Set the next key (in) or value (of) to variable,
+ * return 0 when no more item, only own properties of object are walked.
+ */
+static inline int interp_iter_next(env_t *env, int id, int of) {
+    val_t *idx = env_stack_peek(env);
+    val_t *obj = idx + 1;
+    val_t *var = env_get_var(env, id, 0);
+    int i = val_2_integer(idx);
+
+    if (!var) {
+        env_set_error(env, ERR_SysError);
+        return 0;
+    }
+
+    if (val_is_array(obj)) {
+        array_t *a = (array_t *)val_2_intptr(obj);
+
+        if (i >= array_len(a)) {
+            return 0;
+        }
+        if (of) {
+            *var = array_values(a)[i];
+        } else {
+            val_set_number(var, i);
+        }
+    } else
+    if (val_is_object(obj)) {
+        object_t *o = (object_t *)val_2_intptr(obj);
+
+        if (i >= o->prop_num) {
+            return 0;
+        }
+        if (of) {
+            *var = o->vals[i];
+        } else {
+            val_set_foreign_string(var, o->keys[i]);
+        }
+    } else {
+        return 0;
+    }
+
+    val_set_number(idx, i + 1);
+    return 1;
+}
+
 static inline void interp_prop_get(env_t *env) {
     val_t *key  = env_stack_peek(env);
     val_t *self = key + 1;
@@ -290,8 +416,12 @@ static inline void interp_elem_set(env_t *env) {
     val_t *ref = val_elem_ref(env, obj, key);
 
     if (ref) {
+        if (val_is_array(obj)) {
+            array_elem_stored((array_t *)val_2_intptr(obj), val);
+        }
         val_op_set(env, ref, val, res);
     } else {
+        val_elem_set(env, obj, key, val);
         *res = *val;
     }
     env_stack_release(env, 2);
@@ -556,6 +686,17 @@ static int interp_run(env_t *env, const uint8_t *pc)
         case BC_DICT:       index = (*pc++); index = (index << 8) | (*pc++);
                             interp_dict(env, index); break;
 
+        case BC_CONCAT:     index = *pc++;
+                            interp_concat(env, index); break;
+
+        case BC_FOR_IN:
+        case BC_FOR_OF:     if (interp_iter_next(env, pc[0], code == BC_FOR_OF)) {
+                                pc += 3;
+                            } else {
+                                index = (int8_t) pc[1]; index = (index << 8) | pc[2]; pc += 3 + index;
+                            }
+                            break;
+
         default:            env_set_error(env, ERR_InvalidByteCode);
         }
     }
@@ -647,9 +788,9 @@ int interp_env_init_image(env_t *env, void *mem_ptr, int mem_size, void *heap_pt
     exe->number_map = image_number_entry(image);
     exe->number_num = image->num_cnt;
 
-    exe->string_num = image->str_cnt;
+    // string index, length & hash are built when loaded
     for (i = 0; i < image->str_cnt; i++) {
-        exe->string_map[i] = (intptr_t)image_get_string(image, i);
+        executable_string_find_add(exe, (intptr_t)image_get_string(image, i));
     }
 
     exe->func_num = image->fn_cnt;
@@ -660,6 +801,18 @@ int interp_env_init_image(env_t *env, void *mem_ptr, int mem_size, void *heap_pt
     return 0;
 }
 
+// Result be given to host, string should be contiguous
+static inline val_t *interp_result_pop(env_t *env)
+{
+    val_t *v = env_stack_peek(env);
+
+    if (val_is_heap_string(v) && !string_flatten(env, v)) {
+        val_set_undefined(v);
+    }
+
+    return env_stack_pop(env);
+}
+
 val_t interp_execute_call(env_t *env, int ac)
 {
     uint8_t stop = BC_STOP;
@@ -674,8 +827,68 @@ val_t interp_execute_call(env_t *env, int ac)
     if (env->error) {
         return val_mk_undefined();
     } else {
-        return *env_stack_pop(env);
+        return *interp_result_pop(env);
+    }
+}
+
+int interp_callback_prepare(env_t *env, interp_callback_t *cb, val_t *fn, int ac)
+{
+    int i;
+
+    if (0 > (cb->fp = env_frame_hold(env, ac))) {
+        return -1;
+    }
+
+    cb->fn = fn;
+    cb->ac = ac;
+    cb->av = env->sb + env->sp;
+    cb->reuse = val_is_script(fn) && !function_is_closure((function_t *)val_2_intptr(fn)) ? 1 : 0;
+    for (i = 0; i < ac; i++) {
+        val_set_undefined(cb->av + i);
     }
+
+    return 0;
+}
+
+val_t interp_callback_call(env_t *env, interp_callback_t *cb)
+{
+    uint8_t stop = BC_STOP;
+    const uint8_t *pc;
+
+    if (!val_is_script(cb->fn)) {
+        int i;
+
+        for (i = cb->ac - 1; i >= 0; i--) {
+            env_push_call_argument(env, cb->av + i);
+        }
+        env_push_call_function(env, cb->fn);
+
+        return interp_execute_call(env, cb->ac);
+    }
+
+    // empty function
+    if (function_size((function_t *)val_2_intptr(cb->fn)) == 0) {
+        return val_mk_undefined();
+    }
+
+    pc = env_frame_reenter(env, &stop, cb->fn, cb->ac, cb->av, cb->reuse);
+    if (!pc) {
+        return val_mk_undefined();
+    }
+    if (cb->reuse) {
+        cb->reuse = 2;
+    }
+
+    if (0 != interp_run(env, pc)) {
+        return val_mk_undefined();
+    }
+    return *interp_result_pop(env);
+}
+
+void interp_callback_release(env_t *env, interp_callback_t *cb)
+{
+    // the current scope kept by reused callee is dropped also
+    env_frame_unhold(env, cb->fp);
 }
 
 int interp_execute_image(env_t *env, val_t **v)
@@ -690,7 +903,7 @@ int interp_execute_image(env_t *env, val_t **v)
     }
 
     if (env->fp > env->sp) {
-        *v = env_stack_pop(env);
+        *v = interp_result_pop(env);
     } else {
         *v = NULL;
     }
@@ -698,39 +911,61 @@ int interp_execute_image(env_t *env, val_t **v)
     return 0;
 }
 
-int interp_execute_string(env_t *env, const char *input, val_t **v)
+static int interp_compile_string(env_t *env, const char *input)
 {
-    stmt_t *stmt;
-    heap_t *heap = env_heap_get_free((env_t*)env);
+    heap_t *heap = env_heap_get_free(env);
+    executable_t *exe = &env->exe;
+    int func_num = exe->func_num;
+    int func_code_end = exe->func_code_end;
     parser_t psr;
     compile_t cpl;
+    int ret;
+
+    // The free heap can be used for parse and compile process,
+    // statements are compiled one by one, no whole AST of input be kept.
+    parse_init(&psr, input, NULL, heap->base, heap->size);
+    parse_set_cb(&psr, parse_callback, NULL);
+
+    ret = compile_stream(&cpl, env, &psr);
+    if (ret < 0) {
+        // Drop functions of the statements compiled, they are compiled again by retry
+        exe->func_num = func_num;
+        exe->func_code_end = func_code_end;
+    }
+    return ret;
+}
+
+int interp_execute_string(env_t *env, const char *input, val_t **v)
+{
+    int ret;
 
     if (!env || !input || !v) {
         return -1;
     }
 
-    // The free heap can be used for parse and compile process
-    parse_init(&psr, input, NULL, heap->base, heap->size);
-    parse_set_cb(&psr, parse_callback, NULL);
-    stmt = parse_stmt_multi(&psr);
-    if (!stmt) {
-        //printf("parse error: %d\n", psr.error);
-        return psr.error ? -psr.error : 0;
+    // Reclaim unused code space, before compile new one
+    env_exe_gc(env, 0);
+
+    ret = interp_compile_string(env, input);
+    if (ret < 0 && env->error == ERR_ResourceOutLimit) {
+        // No space for symbal, compile again after unused symbals collected.
+        // Compiler works in the free heap, gc could not be done while compiling.
+        env->error = 0;
+        env_heap_gc(env, 0);
+        ret = interp_compile_string(env, input);
+    }
+    if (0 >= ret) {
+        //printf("parse or compile error: %d\n", ret);
+        return ret;
     }
 
-    compile_init(&cpl, env, heap_free_addr(&psr.heap), heap_free_size(&psr.heap));
-    if (0 == compile_multi_stmt(&cpl, stmt) && 0 == compile_update(&cpl)) {
-        if (0 != interp_run(env, env_main_entry_setup(env, 0, NULL))) {
-            //printf("execute error: %d\n", env->error);
-            return -env->error;
-        }
-    } else {
-        //printf("cmpile error: %d\n", cpl.error);
-        return -cpl.error;
+    if (0 != interp_run(env, env_main_entry_setup(env, 0, NULL))) {
+        //printf("execute error: %d\n", env->error);
+        return -env->error;
     }
 
     if (env->fp > env->sp) {
-        *v = env_stack_pop(env);
+        *v = interp_result_pop(env);
     } else {
         *v = NULL;
     }
@@ -743,12 +978,16 @@ int interp_execute_interactive(env_t *env, const char *input, char *(*input_more
     stmt_t *stmt;
     parser_t psr;
     compile_t cpl;
-    heap_t *heap = env_heap_get_free((env_t*)env);
+    heap_t *heap;
 
     if (!env || !input || !v) {
         return -1;
     }
 
+    // Reclaim unused code space, before compile new one
+    env_exe_gc(env, 0);
+    heap = env_heap_get_free(env);
+
     // The free heap can be used for parse and compile process
     parse_init(&psr, input, input_more, heap->base, heap->size);
     parse_set_cb(&psr, parse_callback, NULL);
@@ -767,7 +1006,7 @@ int interp_execute_interactive(env_t *env, const char *input, char *(*input_more
     }
 
     if (env->fp > env->sp) {
-        *v = env_stack_pop(env);
+        *v = interp_result_pop(env);
     } else {
         *v = NULL;
     }
@@ -787,12 +1026,16 @@ int interp_execute_stmts(env_t *env, const char *input, val_t **v)
     stmt_t *stmt;
     parser_t psr;
     compile_t cpl;
-    heap_t *heap = env_heap_get_free((env_t*)env);
+    heap_t *heap;
 
     if (!env || !input || !v) {
         return -1;
     }
 
+    // Reclaim unused code space, before compile new one
+    env_exe_gc(env, 0);
+    heap = env_heap_get_free(env);
+
     // The free heap can be used for parse and compile process
     parse_init(&psr, input, NULL, heap->base, heap->size);
     parse_set_cb(&psr, parse_callback, NULL);
@@ -809,7 +1052,7 @@ int interp_execute_stmts(env_t *env, const char *input, val_t **v)
         }
 
         if (env->fp > env->sp) {
-            *v = env_stack_pop(env);
+            *v = interp_result_pop(env);
         } else {
             *v = NULL;
         }
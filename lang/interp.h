@@ -41,6 +41,24 @@ int interp_execute_image(env_t *env, val_t **result);
 
 val_t interp_execute_call(env_t *env, int ac);
 
+/*
+ * Callback called repeatedly by native (foreach, map, sort...).
+ * The frame is held once by prepare, arguments are set into av before each call,
+ * they are kept in stack as GC roots. The scope of script callee is reused,
+ * if it is never captured by closure.
+ */
+typedef struct interp_callback_t {
+    val_t *fn;                          // should be a GC root, as argument of native
+    val_t *av;
+    int    ac;
+    int    fp;
+    int    reuse;
+} interp_callback_t;
+
+int   interp_callback_prepare(env_t *env, interp_callback_t *cb, val_t *fn, int ac);
+val_t interp_callback_call(env_t *env, interp_callback_t *cb);
+void  interp_callback_release(env_t *env, interp_callback_t *cb);
+
 
 int interp_execute_stmts(env_t *env, const char *input, val_t **v);
 
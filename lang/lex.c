@@ -72,6 +72,7 @@ static int lex_chk_token_type(const char *str, int len)
         if (0 == strcmp("in", str)) return TOK_IN;
     case 3:
         if (0 == strcmp("def", str)) return TOK_DEF;
+        if (0 == strcmp("for", str)) return TOK_FOR;
         if (0 == strcmp("var", str)) return TOK_VAR;
         if (0 == strcmp("NaN", str)) return TOK_NAN;
         if (0 == strcmp("try", str)) return TOK_TRY;
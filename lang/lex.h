@@ -70,6 +70,7 @@ enum LEX_TOKEN_TYPE{
 
     TOK_IN,
     TOK_IF,
+    TOK_FOR,
     TOK_VAR,
     TOK_DEF,
     TOK_RET,
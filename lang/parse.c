@@ -26,6 +26,7 @@ SOFTWARE.
 #include "ast.h"
 #include "lex.h"
 #include "parse.h"
+#include "type_number.h"
 
 static expr_t *parse_expr_funcdef(parser_t *psr);
 static expr_t *parse_expr_form_parenth(parser_t *psr);
@@ -102,7 +103,7 @@ static inline expr_t *parse_expr_alloc_num(parser_t *psr, const char *text) {
     expr_t *e = (expr_t *) parse_expr_alloc_type(psr, EXPR_NUM);
 
     if (e) {
-        e->body.data.num = atof(text);
+        number_parse(text, strlen(text), &e->body.data.num);
     }
     return e;
 }
@@ -937,6 +938,67 @@ static stmt_t *parse_stmt_while(parser_t *psr)
     return s;
 }
 
+/*
+ * for [var] name in|of expr { ... }, the head could be wrapped by parentheses
+ */
+static stmt_t *parse_stmt_for(parser_t *psr)
+{
+    expr_t *name = NULL, *iter = NULL, *pair;
+    stmt_t *block = NULL;
+    stmt_t *s;
+    token_t token;
+    int parenth, type;
+
+    parse_match(psr, TOK_FOR);
+    parenth = parse_match(psr, '(');
+    parse_match(psr, TOK_VAR);
+
+    if (parse_token(psr, &token) != TOK_ID) {
+        parse_fail(psr, ERR_InvalidToken);
+        return NULL;
+    }
+    if (!(name = parse_expr_alloc_str(psr, EXPR_ID, token.text))) {
+        parse_fail(psr, ERR_NotEnoughMemory);
+        return NULL;
+    }
+    parse_match(psr, TOK_ID);
+
+    if (parse_match(psr, TOK_IN)) {
+        type = STMT_FOR_IN;
+    } else
+    if (parse_token(psr, &token) == TOK_ID && !strcmp(token.text, "of")) {
+        parse_match(psr, TOK_ID);
+        type = STMT_FOR_OF;
+    } else {
+        parse_fail(psr, ERR_InvalidToken);
+        return NULL;
+    }
+
+    if (!(iter = parse_expr(psr))) {
+        return NULL;
+    }
+
+    if (parenth && !parse_match(psr, ')')) {
+        parse_fail(psr, ERR_InvalidToken);
+        return NULL;
+    }
+
+    if (!(pair = parse_expr_form_binary(psr, EXPR_PAIR, name, iter))) {
+        return NULL;
+    }
+
+    if (!(block = parse_stmt_block(psr))) {
+        return NULL;
+    }
+
+    s = parse_stmt_alloc_2(psr, type, pair, block);
+    if (!s) {
+        parse_fail(psr, ERR_NotEnoughMemory);
+    }
+
+    return s;
+}
+
 static stmt_t *parse_stmt_throw(parser_t *psr)
 {
     expr_t *expr = NULL;
@@ -1021,6 +1083,7 @@ stmt_t *parse_stmt(parser_t *psr)
         case TOK_VAR:       parse_post(psr, PARSE_SIMPLE); return parse_stmt_var(psr);
         case TOK_RET:       parse_post(psr, PARSE_SIMPLE); return parse_stmt_ret(psr);
         case TOK_WHILE:     parse_post(psr, PARSE_COMPOSE); return parse_stmt_while(psr);
+        case TOK_FOR:       parse_post(psr, PARSE_COMPOSE); return parse_stmt_for(psr);
         case TOK_BREAK:     parse_post(psr, PARSE_SIMPLE); return parse_stmt_break(psr);
         case TOK_THROW:     parse_post(psr, PARSE_SIMPLE); return parse_stmt_throw(psr);
         case TOK_CONTINUE:  parse_post(psr, PARSE_SIMPLE); return parse_stmt_continue(psr);
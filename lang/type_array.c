@@ -28,77 +28,110 @@ SOFTWARE.
 #include "type_string.h"
 #include "type_array.h"
 
+/*
+ * Size of the storage for len + n elements, doubled from the current one.
+ * Return 0 if it is out of limit.
+ */
+static int array_space_grow_size(env_t *env, array_t *a, int n)
+{
+    int need = array_len(a) + n;
+    int size = a->elem_size < DEF_ELEM_SIZE ? DEF_ELEM_SIZE : a->elem_size * 2;
+
+    if (need > LIMIT_ELEM_SIZE) {
+        env_set_error(env, ERR_ResourceOutLimit);
+        return 0;
+    }
+
+    while (size < need) {
+        size *= 2;
+    }
+
+    return size < LIMIT_ELEM_SIZE ? size : LIMIT_ELEM_SIZE;
+}
+
+/*
+ * Make room for n elements at tail.
+ * Elements are moved to head only if a quarter of storage is still free after,
+ * otherwise the storage is doubled, then push is amortized O(1).
+ */
 static array_t *array_space_extend_tail(env_t *env, val_t *self, int n)
 {
     array_t *a = (array_t *)val_2_intptr(self);
     val_t *elems;
-    int len;
+    int len, size;
 
-    if (a->elem_size - a->elem_end > n) {
+    if (a->elem_size - a->elem_end >= (uint32_t) n) {
         return a;
     }
     len = array_len(a);
 
-    if (a->elem_size -len > n) {
-        memmove(a->elems, a->elems + a->elem_bgn, len);
+    if ((len + n) * 4 <= (int) a->elem_size * 3) {
+        memmove(a->elems, a->elems + a->elem_bgn, sizeof(val_t) * len);
         a->elem_bgn = 0;
         a->elem_end = len;
         return a;
-    } else {
-        int size = SIZE_ALIGN_16(len + n);
-        if (size > UINT16_MAX) {
-            env_set_error(env, ERR_ResourceOutLimit);
-            return NULL;
-        }
-        elems = env_heap_alloc(env, size * sizeof(val_t));
-        if (elems) {
-            a = (array_t *)val_2_intptr(self);
-            memcpy(elems, a->elems + a->elem_bgn, sizeof(val_t) * len);
-            a->elem_size = size;
-            a->elem_bgn = 0;
-            a->elem_end = len;
-            return a;
-        } else {
-            return NULL;
-        }
     }
+
+    if (!(size = array_space_grow_size(env, a, n))) {
+        return NULL;
+    }
+
+    elems = env_heap_alloc(env, size * sizeof(val_t));
+    if (!elems) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return NULL;
+    }
+
+    // defence GC
+    a = (array_t *)val_2_intptr(self);
+    memcpy(elems, a->elems + a->elem_bgn, sizeof(val_t) * len);
+    a->elems = elems;
+    a->elem_size = size;
+    a->elem_bgn = 0;
+    a->elem_end = len;
+
+    return a;
 }
 
+// Make room for n elements at head, as the tail one
 static array_t *array_space_extend_head(env_t *env, val_t *self, int n)
 {
     array_t *a = (array_t *)val_2_intptr(self);
     val_t *elems;
-    int len;
+    int len, size;
 
-    if (a->elem_bgn > n) {
+    if (a->elem_bgn >= (uint32_t) n) {
         return a;
     }
     len = array_len(a);
 
-    if (a->elem_size - len > n) {
-        n = a->elem_size - a->elem_end;
-        memmove(a->elems + a->elem_bgn + n, a->elems + a->elem_bgn, len);
-        a->elem_bgn += n;
-        a->elem_end += n;
+    if ((len + n) * 4 <= (int) a->elem_size * 3) {
+        size = a->elem_size;
+        memmove(a->elems + size - len, a->elems + a->elem_bgn, sizeof(val_t) * len);
+        a->elem_bgn = size - len;
+        a->elem_end = size;
         return a;
-    } else {
-        int size = SIZE_ALIGN_16(len + n);
-        if (size > UINT16_MAX) {
-            env_set_error(env, ERR_ResourceOutLimit);
-            return NULL;
-        }
-        elems = env_heap_alloc(env, size * sizeof(val_t));
-        if (elems) {
-            a = (array_t *)val_2_intptr(self);
-            memcpy(elems + size - len, a->elems + a->elem_bgn, sizeof(val_t) * len);
-            a->elem_size = size;
-            a->elem_bgn = size - len;
-            a->elem_end = size;
-            return a;
-        } else {
-            return NULL;
-        }
     }
+
+    if (!(size = array_space_grow_size(env, a, n))) {
+        return NULL;
+    }
+
+    elems = env_heap_alloc(env, size * sizeof(val_t));
+    if (!elems) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return NULL;
+    }
+
+    // defence GC
+    a = (array_t *)val_2_intptr(self);
+    memcpy(elems + size - len, a->elems + a->elem_bgn, sizeof(val_t) * len);
+    a->elems = elems;
+    a->elem_size = size;
+    a->elem_bgn = size - len;
+    a->elem_end = size;
+
+    return a;
 }
 
 array_t *_array_create(env_t *env, int n)
@@ -106,17 +139,19 @@ array_t *_array_create(env_t *env, int n)
     array_t *array;
     int size = n < DEF_ELEM_SIZE ? DEF_ELEM_SIZE : n;
 
-    if (size > UINT16_MAX) {
+    if (size > LIMIT_ELEM_SIZE) {
         env_set_error(env, ERR_ResourceOutLimit);
         return NULL;
     }
 
-    array = env_heap_alloc(env, sizeof(array_t) + sizeof(val_t) * size);
+    array = env_heap_alloc(env, array_mem_space_of(size));
     if (array) {
         val_t *vals = (val_t *)(array + 1);
 
         array->magic = MAGIC_ARRAY;
         array->age = 0;
+        array->elems_kind = ARRAY_ELEMS_ANY;
+        array->reserved = 0;
         array->elem_size = size;
         array->elem_bgn  = 0;
         array->elem_end  = n;
@@ -132,6 +167,8 @@ intptr_t array_create(env_t *env, int ac, val_t *av)
 
     if (array) {
         memcpy(array->elems + array->elem_bgn, av, sizeof(val_t) * ac);
+        array->elems_kind = ARRAY_ELEMS_NUMBER;
+        array_elems_stored(array, ac, av);
     }
 
     return (intptr_t) array;
@@ -148,10 +185,11 @@ val_t *array_elem_ref(val_t *self, int i)
     }
 }
 
-void array_elem_val(val_t *self, int i, val_t *elem)
+void array_elem_val(void *env, val_t *self, int i, val_t *elem)
 {
     val_t *ref = array_elem_ref(self, i);
 
+    (void) env;
     if (ref) {
         *elem = *ref;
     } else {
@@ -168,6 +206,7 @@ val_t array_push(env_t *env, int ac, val_t *av)
         if (a) {
             memcpy(a->elems + a->elem_end, av + 1, sizeof(val_t) * n);
             a->elem_end += n;
+            array_elems_stored(a, n, av + 1);
             return val_mk_number(array_len(a));
         }
     } else {
@@ -185,6 +224,7 @@ val_t array_unshift(env_t *env, int ac, val_t *av)
         if (a) {
             memcpy(a->elems + a->elem_bgn - n, av + 1, sizeof(val_t) * n);
             a->elem_bgn -= n;
+            array_elems_stored(a, n, av + 1);
             return val_mk_number(array_len(a));
         }
     } else {
@@ -224,18 +264,27 @@ val_t array_shift(env_t *env, int ac, val_t *av)
 val_t array_foreach(env_t *env, int ac, val_t *av)
 {
     if (ac > 1 && val_is_array(av) && val_is_function(av + 1)) {
-        array_t *a = (array_t *)val_2_intptr(av);
-        int i, max = array_len(a);
+        interp_callback_t cb;
+        int i;
 
-        for (i = 0; i < max && !env->error; i++) {
-            val_t key = val_mk_number(i);
+        if (interp_callback_prepare(env, &cb, av + 1, 2)) {
+            return val_mk_undefined();
+        }
 
-            env_push_call_argument(env, &key);
-            env_push_call_argument(env, array_values(a) + i);
-            env_push_call_function(env, av + 1);
+        for (i = 0; !env->error; i++) {
+            // defence GC, array may be moved or changed by callback
+            array_t *a = (array_t *)val_2_intptr(av);
 
-            interp_execute_call(env, 2);
+            if (i >= array_len(a)) {
+                break;
+            }
+
+            cb.av[0] = array_values(a)[i];
+            val_set_number(cb.av + 1, i);
+            interp_callback_call(env, &cb);
         }
+
+        interp_callback_release(env, &cb);
     }
 
     return val_mk_undefined();
@@ -257,3 +306,644 @@ val_t array_length(env_t *env, int ac, val_t *av)
     return val_mk_number(len);
 }
 
+
+/*
+ * Flatten the rope elements, to be viewed as contiguous string.
+ * Return 0 if failed (memory not enough).
+ */
+static int array_elems_flatten(env_t *env, val_t *self)
+{
+    int i;
+
+    for (i = 0; i < array_len((array_t *)val_2_intptr(self)); i++) {
+        val_t *elem = _array_element(self, i);
+
+        if (string_is_rope(elem)) {
+            // elements may be moved by GC, flatten a copy in stack
+            val_t *tmp = env_stack_push(env);
+
+            *tmp = *elem;
+            if (!string_flatten(env, tmp)) {
+                env_stack_pop(env);
+                return 0;
+            }
+            *_array_element(self, i) = *tmp;
+            env_stack_pop(env);
+        }
+    }
+
+    return 1;
+}
+
+static int array_index_normalize(int i, int len)
+{
+    if (i < 0) {
+        i += len;
+        return i < 0 ? 0 : i;
+    }
+    return i > len ? len : i;
+}
+
+// A new array with copy of n values
+static val_t array_of_values(env_t *env, val_t *self, int start, int n)
+{
+    array_t *a = _array_create(env, n);
+
+    if (!a) {
+        return val_mk_undefined();
+    }
+
+    // defence GC
+    memcpy(a->elems, array_values((array_t *)val_2_intptr(self)) + start, sizeof(val_t) * n);
+    a->elems_kind = ARRAY_ELEMS_NUMBER;
+    array_elems_stored(a, n, a->elems);
+
+    return val_mk_array(a);
+}
+
+typedef struct array_sort_t {
+    env_t *env;
+    val_t *self;
+    interp_callback_t *cb;
+    val_t *elems;
+    int    len;
+    int    stop;
+    int  (*compare)(struct array_sort_t *, int, int);
+} array_sort_t;
+
+static int array_sort_number(array_sort_t *ctx, int i, int j)
+{
+    double a = val_2_double(ctx->elems + i);
+    double b = val_2_double(ctx->elems + j);
+
+    return a < b ? -1 : a > b;
+}
+
+static int array_sort_string(array_sort_t *ctx, int i, int j)
+{
+    return string_compare(ctx->elems + i, ctx->elems + j);
+}
+
+// Numbers first, then strings, others are kept as equal at the last
+static int array_sort_rank(val_t *v)
+{
+    return val_is_number(v) ? 0 : val_is_string(v) ? 1 : 2;
+}
+
+static int array_sort_default(array_sort_t *ctx, int i, int j)
+{
+    val_t *a = ctx->elems + i, *b = ctx->elems + j;
+    int ra = array_sort_rank(a), rb = array_sort_rank(b);
+
+    if (ra != rb || ra == 2) {
+        return ra - rb;
+    }
+    return ra ? string_compare(a, b) : array_sort_number(ctx, i, j);
+}
+
+static int array_sort_callback(array_sort_t *ctx, int i, int j)
+{
+    val_t res;
+    array_t *a;
+
+    if (ctx->stop) {
+        return 0;
+    }
+
+    ctx->cb->av[0] = ctx->elems[i];
+    ctx->cb->av[1] = ctx->elems[j];
+    res = interp_callback_call(ctx->env, ctx->cb);
+
+    // defence GC, array may be moved or changed by callback
+    a = (array_t *)val_2_intptr(ctx->self);
+    ctx->elems = array_values(a);
+    if (ctx->env->error || array_len(a) != ctx->len) {
+        ctx->stop = 1;
+        return 0;
+    }
+
+    if (val_is_number(&res)) {
+        double d = val_2_double(&res);
+        return d < 0 ? -1 : d > 0;
+    }
+    return 0;
+}
+
+static inline void array_sort_swap(array_sort_t *ctx, int i, int j)
+{
+    if (!ctx->stop) {
+        val_t t = ctx->elems[i];
+
+        ctx->elems[i] = ctx->elems[j];
+        ctx->elems[j] = t;
+    }
+}
+
+static void array_sort_insertion(array_sort_t *ctx, int lo, int hi)
+{
+    int i, j;
+
+    for (i = lo + 1; i <= hi; i++) {
+        for (j = i; j > lo && ctx->compare(ctx, j - 1, j) > 0; j--) {
+            array_sort_swap(ctx, j - 1, j);
+        }
+    }
+}
+
+static void array_sort_sift(array_sort_t *ctx, int lo, int root, int n)
+{
+    int child;
+
+    while ((child = root * 2 + 1) < n) {
+        if (child + 1 < n && ctx->compare(ctx, lo + child, lo + child + 1) < 0) {
+            child++;
+        }
+        if (ctx->compare(ctx, lo + root, lo + child) >= 0) {
+            return;
+        }
+        array_sort_swap(ctx, lo + root, lo + child);
+        root = child;
+    }
+}
+
+static void array_sort_heap(array_sort_t *ctx, int lo, int hi)
+{
+    int n = hi - lo + 1, i;
+
+    for (i = n / 2 - 1; i >= 0; i--) {
+        array_sort_sift(ctx, lo, i, n);
+    }
+    for (i = n - 1; i > 0; i--) {
+        array_sort_swap(ctx, lo, lo + i);
+        array_sort_sift(ctx, lo, 0, i);
+    }
+}
+
+/*
+ * Introsort: quick sort with median of three pivot, heap sort if it goes too deep,
+ * insertion sort for the short range. Recurse into the smaller part only.
+ */
+static void array_sort_intro(array_sort_t *ctx, int lo, int hi, int depth)
+{
+    while (hi - lo > 16 && !ctx->stop) {
+        int mid = lo + (hi - lo) / 2;
+        int i, j;
+
+        if (depth-- == 0) {
+            array_sort_heap(ctx, lo, hi);
+            return;
+        }
+
+        // median of lo, mid, hi is moved to lo as pivot
+        if (ctx->compare(ctx, mid, lo) < 0) array_sort_swap(ctx, mid, lo);
+        if (ctx->compare(ctx, hi, lo) < 0)  array_sort_swap(ctx, hi, lo);
+        if (ctx->compare(ctx, hi, mid) < 0) array_sort_swap(ctx, hi, mid);
+        array_sort_swap(ctx, lo, mid);
+
+        i = lo;
+        j = hi + 1;
+        while (1) {
+            do { i++; } while (i < hi && ctx->compare(ctx, i, lo) < 0);
+            do { j--; } while (j > lo && ctx->compare(ctx, lo, j) < 0);
+            if (i >= j) {
+                break;
+            }
+            array_sort_swap(ctx, i, j);
+        }
+        array_sort_swap(ctx, lo, j);
+
+        if (j - lo < hi - j) {
+            array_sort_intro(ctx, lo, j - 1, depth);
+            lo = j + 1;
+        } else {
+            array_sort_intro(ctx, j + 1, hi, depth);
+            hi = j - 1;
+        }
+    }
+
+    if (!ctx->stop) {
+        array_sort_insertion(ctx, lo, hi);
+    }
+}
+
+// sort([compare]), in place
+val_t array_sort(env_t *env, int ac, val_t *av)
+{
+    interp_callback_t cb;
+    array_sort_t ctx;
+    array_t *a;
+    int i, depth;
+
+    if (ac < 1 || !val_is_array(av) || (ac > 1 && !val_is_function(av + 1))) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    if (!array_elems_flatten(env, av)) {
+        return val_mk_undefined();
+    }
+    if (ac > 1 && interp_callback_prepare(env, &cb, av + 1, 2)) {
+        return val_mk_undefined();
+    }
+    a = (array_t *)val_2_intptr(av);
+
+    ctx.env = env;
+    ctx.self = av;
+    ctx.cb = &cb;
+    ctx.elems = array_values(a);
+    ctx.len = array_len(a);
+    ctx.stop = 0;
+
+    if (ac > 1) {
+        ctx.compare = array_sort_callback;
+    } else
+    if (array_is_number_elems(a)) {
+        ctx.compare = array_sort_number;
+    } else {
+        for (i = 0; i < ctx.len && val_is_string(ctx.elems + i); i++)
+            ;
+        ctx.compare = i == ctx.len ? array_sort_string : array_sort_default;
+    }
+
+    for (depth = 0, i = ctx.len; i > 1; i >>= 1) {
+        depth += 2;
+    }
+    array_sort_intro(&ctx, 0, ctx.len - 1, depth);
+
+    if (ac > 1) {
+        interp_callback_release(env, &cb);
+    }
+
+    return *av;
+}
+
+val_t array_reverse(env_t *env, int ac, val_t *av)
+{
+    if (ac > 0 && val_is_array(av)) {
+        array_t *a = (array_t *)val_2_intptr(av);
+        val_t *p = array_values(a), *q = p + array_len(a) - 1;
+
+        while (p < q) {
+            val_t t = *p;
+            *p++ = *q;
+            *q-- = t;
+        }
+        return *av;
+    }
+
+    env_set_error(env, ERR_InvalidInput);
+    return val_mk_undefined();
+}
+
+// indexOf(value[, from]), return -1 if not found
+val_t array_index_of(env_t *env, int ac, val_t *av)
+{
+    array_t *a;
+    int i = 0, len;
+
+    if (ac < 2 || !val_is_array(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    if (val_is_string(av + 1) && !array_elems_flatten(env, av)) {
+        return val_mk_undefined();
+    }
+    a = (array_t *)val_2_intptr(av);
+    len = array_len(a);
+
+    if (ac > 2 && val_is_number(av + 2)) {
+        i = array_index_normalize(val_2_integer(av + 2), len);
+    }
+
+    if (val_is_number(av + 1)) {
+        val_t *elems = array_values(a);
+
+        // same number is the same value
+        for (; i < len; i++) {
+            if (elems[i] == av[1]) {
+                return val_mk_number(i);
+            }
+        }
+    } else {
+        for (; i < len; i++) {
+            if (val_is_equal(array_values(a) + i, av + 1)) {
+                return val_mk_number(i);
+            }
+        }
+    }
+
+    return val_mk_number(-1);
+}
+
+// slice([start[, end]]), negative index counts from the end
+val_t array_slice(env_t *env, int ac, val_t *av)
+{
+    int len, start = 0, end;
+
+    if (ac < 1 || !val_is_array(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    len = array_len((array_t *)val_2_intptr(av));
+    end = len;
+    if (ac > 1 && val_is_number(av + 1)) {
+        start = array_index_normalize(val_2_integer(av + 1), len);
+    }
+    if (ac > 2 && val_is_number(av + 2)) {
+        end = array_index_normalize(val_2_integer(av + 2), len);
+    }
+
+    return array_of_values(env, av, start, end > start ? end - start : 0);
+}
+
+// concat(...), elements of array arguments are appended, others are appended as is
+val_t array_concat(env_t *env, int ac, val_t *av)
+{
+    array_t *a;
+    int i, n;
+
+    if (ac < 1 || !val_is_array(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    for (n = 0, i = 0; i < ac; i++) {
+        n += val_is_array(av + i) ? array_len((array_t *)val_2_intptr(av + i)) : 1;
+    }
+
+    a = _array_create(env, n);
+    if (!a) {
+        return val_mk_undefined();
+    }
+
+    // defence GC
+    for (n = 0, i = 0; i < ac; i++) {
+        if (val_is_array(av + i)) {
+            array_t *src = (array_t *)val_2_intptr(av + i);
+
+            memcpy(a->elems + n, array_values(src), sizeof(val_t) * array_len(src));
+            n += array_len(src);
+        } else {
+            a->elems[n++] = av[i];
+        }
+    }
+    a->elems_kind = ARRAY_ELEMS_NUMBER;
+    array_elems_stored(a, n, a->elems);
+
+    return val_mk_array(a);
+}
+
+// Text of element in join, number is formatted into buf
+static const char *array_join_piece(env_t *env, val_t *v, char *buf, int *len)
+{
+    const char *s;
+
+    if (val_is_string(v)) {
+        if (val_is_foreign_string(v)) {
+            *len = string_length_of(env, v);
+            return val_2_cstring(v);
+        }
+        return string_view(v, len);
+    } else
+    if (val_is_number(v)) {
+        *len = number_to_cstr(val_2_double(v), buf);
+        return buf;
+    } else
+    if (val_is_boolean(v)) {
+        s = val_2_intptr(v) ? "true" : "false";
+    } else
+    if (val_is_undefined(v)) {
+        s = "<undefined>";
+    } else
+    if (val_is_nan(v)) {
+        s = "<NaN>";
+    } else
+    if (val_is_function(v)) {
+        s = "<function>";
+    } else
+    if (val_is_array(v)) {
+        s = "<array>";
+    } else {
+        s = "<object>";
+    }
+
+    *len = strlen(s);
+    return s;
+}
+
+// join([separator]), the result is allocated once
+val_t array_join(env_t *env, int ac, val_t *av)
+{
+    char buf[NUMBER_STR_MAX];
+    const char *sep = ",", *s;
+    int sep_len = 1, total, len, i, n;
+    val_t res;
+    char *p;
+
+    if (ac < 1 || !val_is_array(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    if (ac > 1 && val_is_string(av + 1)) {
+        sep = array_join_piece(env, av + 1, buf, &sep_len);
+    }
+
+    if (!array_elems_flatten(env, av)) {
+        return val_mk_undefined();
+    }
+
+    n = array_len((array_t *)val_2_intptr(av));
+    for (total = 0, i = 0; i < n; i++) {
+        array_join_piece(env, _array_element(av, i), buf, &len);
+        total += len + (i ? sep_len : 0);
+    }
+
+    if (total == 0) {
+        return val_mk_foreign_string((intptr_t)"");
+    }
+    if (total > STRING_LEN_MAX) {
+        env_set_error(env, ERR_ResourceOutLimit);
+        return val_mk_undefined();
+    }
+
+    res = string_create_heap_val(env, total);
+    if (val_is_undefined(&res)) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return res;
+    }
+
+    // defence GC
+    if (ac > 1 && val_is_string(av + 1)) {
+        sep = array_join_piece(env, av + 1, buf, &sep_len);
+    }
+    p = (char *)val_2_cstring(&res);
+    for (i = 0; i < n; i++) {
+        if (i) {
+            memcpy(p, sep, sep_len);
+            p += sep_len;
+        }
+        s = array_join_piece(env, _array_element(av, i), buf, &len);
+        memcpy(p, s, len);
+        p += len;
+    }
+
+    return res;
+}
+
+// map(fn), fn(value, index) makes the element of new array
+val_t array_map(env_t *env, int ac, val_t *av)
+{
+    interp_callback_t cb;
+    val_t *res;
+    array_t *a;
+    int i, n, all_number = 1;
+
+    if (ac < 2 || !val_is_array(av) || !val_is_function(av + 1)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    n = array_len((array_t *)val_2_intptr(av));
+    a = _array_create(env, n);
+    if (!a) {
+        return val_mk_undefined();
+    }
+    for (i = 0; i < n; i++) {
+        val_set_undefined(a->elems + i);
+    }
+
+    // keep result in stack, defence GC
+    res = env_stack_push(env);
+    val_set_array(res, (intptr_t)a);
+
+    if (interp_callback_prepare(env, &cb, av + 1, 2)) {
+        return val_mk_undefined();
+    }
+
+    for (i = 0; i < n && !env->error; i++) {
+        val_t v;
+
+        // array may be moved or changed by callback
+        a = (array_t *)val_2_intptr(av);
+        if (i >= array_len(a)) {
+            break;
+        }
+
+        cb.av[0] = array_values(a)[i];
+        val_set_number(cb.av + 1, i);
+        v = interp_callback_call(env, &cb);
+
+        all_number = all_number && val_is_number(&v);
+        array_values((array_t *)val_2_intptr(res))[i] = v;
+    }
+    interp_callback_release(env, &cb);
+
+    a = (array_t *)val_2_intptr(res);
+    a->elem_end = a->elem_bgn + i;
+    if (all_number) {
+        a->elems_kind = ARRAY_ELEMS_NUMBER;
+    }
+
+    return *res;
+}
+
+// filter(fn), elements which fn(value, index) is true make the new array
+val_t array_filter(env_t *env, int ac, val_t *av)
+{
+    interp_callback_t cb;
+    val_t *res;
+    array_t *a;
+    int i;
+
+    if (ac < 2 || !val_is_array(av) || !val_is_function(av + 1)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    a = _array_create(env, 0);
+    if (!a) {
+        return val_mk_undefined();
+    }
+    a->elems_kind = ARRAY_ELEMS_NUMBER;
+
+    // keep result in stack, defence GC
+    res = env_stack_push(env);
+    val_set_array(res, (intptr_t)a);
+
+    if (interp_callback_prepare(env, &cb, av + 1, 2)) {
+        return val_mk_undefined();
+    }
+
+    for (i = 0; !env->error; i++) {
+        val_t v;
+
+        a = (array_t *)val_2_intptr(av);
+        if (i >= array_len(a)) {
+            break;
+        }
+
+        cb.av[0] = array_values(a)[i];
+        val_set_number(cb.av + 1, i);
+        v = interp_callback_call(env, &cb);
+
+        // the element is kept in cb.av, defence GC
+        if (!env->error && val_is_true(&v)) {
+            if (!(a = array_space_extend_tail(env, res, 1))) {
+                break;
+            }
+            a->elems[a->elem_end++] = cb.av[0];
+            array_elem_stored(a, cb.av);
+        }
+    }
+    interp_callback_release(env, &cb);
+
+    return *res;
+}
+
+// reduce(fn[, initial]), fn(accumulator, value, index)
+val_t array_reduce(env_t *env, int ac, val_t *av)
+{
+    interp_callback_t cb;
+    val_t *acc;
+    array_t *a;
+    int i = 0;
+
+    if (ac < 2 || !val_is_array(av) || !val_is_function(av + 1)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+    a = (array_t *)val_2_intptr(av);
+
+    // keep accumulator in stack, defence GC
+    acc = env_stack_push(env);
+    if (ac > 2) {
+        *acc = av[2];
+    } else
+    if (array_len(a) > 0) {
+        *acc = array_values(a)[i++];
+    } else {
+        return val_mk_undefined();
+    }
+
+    if (interp_callback_prepare(env, &cb, av + 1, 3)) {
+        return val_mk_undefined();
+    }
+
+    for (; !env->error; i++) {
+        a = (array_t *)val_2_intptr(av);
+        if (i >= array_len(a)) {
+            break;
+        }
+
+        cb.av[0] = *acc;
+        cb.av[1] = array_values(a)[i];
+        val_set_number(cb.av + 2, i);
+        *acc = interp_callback_call(env, &cb);
+    }
+    interp_callback_release(env, &cb);
+
+    return *acc;
+}
@@ -32,17 +32,47 @@ SOFTWARE.
 
 #define MAGIC_ARRAY         (MAGIC_BASE + 11)
 
+#define ARRAY_ELEMS_ANY     0
+#define ARRAY_ELEMS_NUMBER  1   // numbers only, skipped by gc
+
+/*
+ * Elements are kept in [elem_bgn, elem_end) of elems, which follow the head at first.
+ * A grown storage is allocated alone, gc copies it back behind the head.
+ */
 typedef struct array_t {
     uint8_t magic;
     uint8_t age;
-    uint16_t elem_size;
-    uint16_t elem_bgn;
-    uint16_t elem_end;
+    uint8_t elems_kind;
+    uint8_t reserved;
+    uint32_t elem_size;
+    uint32_t elem_bgn;
+    uint32_t elem_end;
     val_t *elems;
 } array_t;
 
+static inline int array_mem_space_of(int size) {
+    return SIZE_ALIGN(sizeof(array_t) + sizeof(val_t) * size);
+}
+
 static inline int array_mem_space(array_t *a) {
-    return SIZE_ALIGN(sizeof(array_t) + sizeof(val_t) * a->elem_size);
+    return array_mem_space_of(a->elem_size);
+}
+
+static inline int array_is_number_elems(array_t *a) {
+    return a->elems_kind == ARRAY_ELEMS_NUMBER;
+}
+
+// Should be called when v is stored into array, the kind never goes back
+static inline void array_elem_stored(array_t *a, val_t *v) {
+    if (!val_is_number(v)) {
+        a->elems_kind = ARRAY_ELEMS_ANY;
+    }
+}
+
+static inline void array_elems_stored(array_t *a, int n, val_t *v) {
+    while (n-- > 0 && a->elems_kind == ARRAY_ELEMS_NUMBER) {
+        array_elem_stored(a, v++);
+    }
 }
 
 static inline int array_is_true(val_t *v) {
@@ -61,12 +91,12 @@ static inline int array_len(array_t *a) {
 static inline
 val_t *_array_element(val_t *array, int i) {
     array_t *a = (array_t *)val_2_intptr(array);
-    return (a->elem_bgn + i < a->elem_end) ? (a->elems + i) : NULL;
+    return (a->elem_bgn + i < a->elem_end) ? (a->elems + a->elem_bgn + i) : NULL;
 }
 
 static inline
 val_t *_array_elem(array_t *a, int i) {
-    return (a->elem_bgn + i < a->elem_end) ? (a->elems + i) : NULL;
+    return (a->elem_bgn + i < a->elem_end) ? (a->elems + a->elem_bgn + i) : NULL;
 }
 
 array_t *_array_create(env_t *env, int len);
@@ -78,8 +108,17 @@ val_t array_pop(env_t *env, int ac, val_t *av);
 val_t array_shift(env_t *env, int ac, val_t *av);
 val_t array_unshift(env_t *env, int ac, val_t *av);
 val_t array_foreach(env_t *env, int ac, val_t *av);
-
-void array_elem_val(val_t *self, int i, val_t *elem);
+val_t array_sort(env_t *env, int ac, val_t *av);
+val_t array_reverse(env_t *env, int ac, val_t *av);
+val_t array_index_of(env_t *env, int ac, val_t *av);
+val_t array_slice(env_t *env, int ac, val_t *av);
+val_t array_concat(env_t *env, int ac, val_t *av);
+val_t array_join(env_t *env, int ac, val_t *av);
+val_t array_map(env_t *env, int ac, val_t *av);
+val_t array_filter(env_t *env, int ac, val_t *av);
+val_t array_reduce(env_t *env, int ac, val_t *av);
+
+void array_elem_val(void *env, val_t *self, int i, val_t *elem);
 val_t *array_elem_ref(val_t *self, int i);
 
 #endif /* __LANG_ARRAY_INC__ */
@@ -24,11 +24,26 @@ SOFTWARE.
 
 #include "err.h"
 #include "type_string.h"
+#include "type_array.h"
 #include "type_buffer.h"
+#include "checksum.h"
+
+// Kinds of field: type | size in bytes
+#define FIELD_INT       0x00
+#define FIELD_UINT      0x10
+#define FIELD_FLOAT     0x20
+#define FIELD_PAD       0x31
+#define FIELD_SIZE(k)   ((k) & 0x0f)
 
 static inline type_buffer_t *buffer_alloc(env_t *env, int size)
 {
-    type_buffer_t *b = env_heap_alloc(env, SIZE_ALIGN(sizeof(type_buffer_t) + size));
+    type_buffer_t *b;
+
+    if (size < 0 || size > BUFFER_SIZE_MAX - (int)sizeof(type_buffer_t) - 8) {
+        return NULL;
+    }
+
+    b = env_heap_alloc(env, SIZE_ALIGN(sizeof(type_buffer_t) + size));
 
     if (b) {
         b->magic = MAGIC_BUFFER;
@@ -43,49 +58,137 @@ type_buffer_t *buffer_create(env_t *env, int size)
     return buffer_alloc(env, size);
 }
 
-type_buffer_t *buffer_slice(env_t *env, type_buffer_t *b, int start, int size)
+/*
+ * Wrap the bytes out of heap as buffer, it's owned by env since now.
+ * release is called when buffer is dropped by gc or env deinited.
+ */
+type_buffer_t *buffer_create_extern(env_t *env, void *data, int len, buffer_release_t release)
 {
-    type_buffer_t *slice;
+    type_buffer_extern_t *b;
+
+    if (len < 0 || (len && !data)) {
+        env_set_error(env, ERR_InvalidInput);
+        return NULL;
+    }
 
-    if (start < 0) {
-        start = 0;
+    b = env_heap_alloc(env, buffer_mem_space_extern());
+    if (!b) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return NULL;
     }
 
-    if (start + size > b->len) {
-        size = b->len - start;
-        if (size < 0) {
-            size = 0;
+    b->magic = MAGIC_BUFFER_EXTERN;
+    b->age = 0;
+    b->len = len;
+    b->data = data;
+    b->release = release;
+    b->next = env->extern_list;
+    env->extern_list = b;
+
+    return (type_buffer_t *) b;
+}
+
+void buffer_extern_release_all(env_t *env)
+{
+    type_buffer_extern_t *b = env->extern_list;
+
+    env->extern_list = NULL;
+    for (; b; b = b->next) {
+        if (b->release) {
+            b->release(b->data, b->len);
         }
     }
+}
 
-    slice = buffer_alloc(env, size);
-    if (slice) {
-        memcpy(slice->buf, b->buf + start, size);
+static void buffer_range_fix(type_buffer_t *b, int *start, int *size)
+{
+    int len = _buffer_size(b);
+
+    if (*start < 0) {
+        *start = 0;
+    }
+    if (*size < 0) {
+        *size = 0;
+    }
+
+    if (*start + *size > len) {
+        *size = len - *start;
+        if (*size < 0) {
+            *start = len;
+            *size = 0;
+        }
+    }
+}
+
+/*
+ * Slice shares bytes with b, no bytes are copied.
+ */
+type_buffer_t *buffer_slice(env_t *env, val_t *b, int start, int size)
+{
+    type_buffer_slice_t *slice;
+    type_buffer_t *buf;
+
+    buffer_range_fix((type_buffer_t *) val_2_intptr(b), &start, &size);
+
+    slice = env_heap_alloc(env, buffer_mem_space_slice());
+    if (!slice) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return NULL;
+    }
+
+    // defence GC
+    buf = (type_buffer_t *) val_2_intptr(b);
+
+    slice->magic = MAGIC_BUFFER_SLICE;
+    slice->age = 0;
+    slice->len = size;
+    if (buffer_is_slice(buf)) {
+        slice->off = ((type_buffer_slice_t *) buf)->off + start;
+        slice->parent = ((type_buffer_slice_t *) buf)->parent;
+    } else {
+        slice->off = start;
+        slice->parent = *b;
+    }
+
+    return (type_buffer_t *) slice;
+}
+
+type_buffer_t *buffer_copy(env_t *env, val_t *b, int start, int size)
+{
+    type_buffer_t *copy;
+
+    buffer_range_fix((type_buffer_t *) val_2_intptr(b), &start, &size);
+
+    copy = buffer_alloc(env, size);
+    if (copy) {
+        // defence GC
+        memcpy(copy->buf, (uint8_t *)_val_buffer_addr(b) + start, size);
     } else {
         env_set_error(env, ERR_NotEnoughMemory);
     }
-    return slice;
+    return copy;
 }
 
 int buffer_read_int(type_buffer_t *b, int off, int size, int be, int *v)
 {
-    if (off >= 0 && size > 0 && off + size <= b->len) {
+    if (off >= 0 && size > 0 && off + size <= _buffer_size(b)) {
+        uint8_t *p = _buffer_addr(b);
         int num = 0, i;
         int8_t s;
 
         if (be) {
-            s = b->buf[off];
+            s = p[off];
             num = s;
             for (i = 1; i < size; i++) {
                 num <<= 8;
-                num |= b->buf[off + i];
+                num |= p[off + i];
             }
         } else {
-            s = b->buf[off + size - 1];
+            s = p[off + size - 1];
             num = s;
             for (i = size - 2; i > -1; i--) {
                 num <<= 8;
-                num |= b->buf[off + i];
+                num |= p[off + i];
             }
         }
         *v = num;
@@ -97,20 +200,21 @@ int buffer_read_int(type_buffer_t *b, int off, int size, int be, int *v)
 
 int buffer_write_int(type_buffer_t *b, int off, int size, int be, int num)
 {
-    if (off >= 0 && size > 0 && off + size <= b->len) {
+    if (off >= 0 && size > 0 && off + size <= _buffer_size(b)) {
+        uint8_t *p = _buffer_addr(b);
         int i;
 
         if (be) {
-            b->buf[off + size - 1] = num;
+            p[off + size - 1] = num;
             for (i = size - 2; i > -1; i--) {
                 num >>= 8;
-                b->buf[off + i] = num;
+                p[off + i] = num;
             }
         } else {
-            b->buf[off] = num;
+            p[off] = num;
             for (i = 1; i < size; i++) {
                 num >>= 8;
-                b->buf[off + i] = num;
+                p[off + i] = num;
             }
         }
 
@@ -140,7 +244,8 @@ val_t buffer_native_create(env_t *env, int ac, val_t *av)
     buf = buffer_alloc(env, size);
     if (buf) {
         if (data) {
-            memcpy(buf->buf, data, size);
+            // defence GC, heap string may be moved
+            memcpy(buf->buf, val_2_cstring(av), size);
         }
         return val_mk_buffer(buf);
     } else {
@@ -222,8 +327,9 @@ val_t buffer_native_to_string(env_t *env, int ac, val_t *av)
     }
 
     buf = (type_buffer_t *)val_2_intptr(av);
-    for (len = 0; len < buf->len; len++) {
-        uint8_t ch = buf->buf[len];
+    ptr = _buffer_addr(buf);
+    for (len = 0; len < _buffer_size(buf); len++) {
+        uint8_t ch = ptr[len];
         if (ch < ' ' || ch >= 127) {
             break;
         }
@@ -233,28 +339,26 @@ val_t buffer_native_to_string(env_t *env, int ac, val_t *av)
     str = (void *)val_2_cstring(&s);
     if (str && len) {
         // defence GC
-        buf = (type_buffer_t *)val_2_intptr(av);
-        ptr = buf->buf;
-
-        memcpy(str, ptr, len);
+        memcpy(str, _val_buffer_addr(av), len);
     }
 
     return s;
 }
 
-val_t buffer_native_slice(env_t *env, int ac, val_t *av)
+static int buffer_range_parse(env_t *env, int ac, val_t *av, int *start, int *size)
 {
-    type_buffer_t *buf, *slice;
-    int start = 0, end = -1;
+    type_buffer_t *buf;
+    int end = -1;
 
     if (ac < 1 || !val_is_buffer(av)) {
         env_set_error(env, ERR_InvalidInput);
-        return VAL_UNDEFINED;
+        return -1;
     }
 
     buf = (type_buffer_t *)val_2_intptr(av);
+    *start = 0;
     if (ac > 1 && val_is_number(av + 1)) {
-        start = val_2_integer(av + 1);
+        *start = val_2_integer(av + 1);
         if (ac > 2 && val_is_number(av + 2)) {
             end = val_2_integer(av + 2);
         }
@@ -264,11 +368,24 @@ val_t buffer_native_slice(env_t *env, int ac, val_t *av)
         end = buf->len;
     }
 
-    if (start > end) {
-        end = start;
+    if (*start > end) {
+        end = *start;
     }
+    *size = end - *start;
+
+    return 0;
+}
+
+val_t buffer_native_slice(env_t *env, int ac, val_t *av)
+{
+    type_buffer_t *slice;
+    int start, size;
 
-    slice = buffer_slice(env, buf, start, end - start);
+    if (buffer_range_parse(env, ac, av, &start, &size)) {
+        return VAL_UNDEFINED;
+    }
+
+    slice = buffer_slice(env, av, start, size);
     if (slice) {
         return val_mk_buffer(slice);
     } else {
@@ -276,13 +393,407 @@ val_t buffer_native_slice(env_t *env, int ac, val_t *av)
     }
 }
 
-void buffer_elem_get(val_t *self, int index, val_t *elem)
+val_t buffer_native_copy(env_t *env, int ac, val_t *av)
+{
+    type_buffer_t *copy;
+    int start, size;
+
+    if (buffer_range_parse(env, ac, av, &start, &size)) {
+        return VAL_UNDEFINED;
+    }
+
+    copy = buffer_copy(env, av, start, size);
+    if (copy) {
+        return val_mk_buffer(copy);
+    } else {
+        return VAL_UNDEFINED;
+    }
+}
+
+/*
+ * Fields are loaded & stored by memcpy, which is a single unaligned access
+ * on most targets, and swapped when byte order is not the host's.
+ */
+static inline uint16_t field_load16(const uint8_t *p, int swap) {
+    uint16_t v; memcpy(&v, p, 2); return swap ? __builtin_bswap16(v) : v;
+}
+static inline uint32_t field_load32(const uint8_t *p, int swap) {
+    uint32_t v; memcpy(&v, p, 4); return swap ? __builtin_bswap32(v) : v;
+}
+static inline uint64_t field_load64(const uint8_t *p, int swap) {
+    uint64_t v; memcpy(&v, p, 8); return swap ? __builtin_bswap64(v) : v;
+}
+static inline void field_store16(uint8_t *p, int swap, uint16_t v) {
+    v = swap ? __builtin_bswap16(v) : v; memcpy(p, &v, 2);
+}
+static inline void field_store32(uint8_t *p, int swap, uint32_t v) {
+    v = swap ? __builtin_bswap32(v) : v; memcpy(p, &v, 4);
+}
+static inline void field_store64(uint8_t *p, int swap, uint64_t v) {
+    v = swap ? __builtin_bswap64(v) : v; memcpy(p, &v, 8);
+}
+
+static double field_get(const uint8_t *p, int kind, int swap)
+{
+    uint32_t u32;
+    uint64_t u64;
+    float  f;
+    double d;
+
+    switch (kind) {
+    case FIELD_INT | 1:     return (int8_t) p[0];
+    case FIELD_UINT | 1:    return p[0];
+    case FIELD_INT | 2:     return (int16_t) field_load16(p, swap);
+    case FIELD_UINT | 2:    return field_load16(p, swap);
+    case FIELD_INT | 4:     return (int32_t) field_load32(p, swap);
+    case FIELD_UINT | 4:    return field_load32(p, swap);
+    case FIELD_INT | 8:     return (int64_t) field_load64(p, swap);
+    case FIELD_UINT | 8:    return field_load64(p, swap);
+    case FIELD_FLOAT | 4:   u32 = field_load32(p, swap); memcpy(&f, &u32, 4); return f;
+    default:                u64 = field_load64(p, swap); memcpy(&d, &u64, 8); return d;
+    }
+}
+
+// Integers are truncated and wrapped to the field, NaN and the out of range ones are 0
+static void field_set(uint8_t *p, int kind, int swap, double d)
+{
+    int64_t n = (d > -9.2e18 && d < 9.2e18) ? (int64_t) d : 0;
+    uint32_t u32;
+    uint64_t u64;
+    float  f;
+
+    switch (kind) {
+    case FIELD_INT | 1:
+    case FIELD_UINT | 1:    p[0] = n; break;
+    case FIELD_INT | 2:
+    case FIELD_UINT | 2:    field_store16(p, swap, n); break;
+    case FIELD_INT | 4:
+    case FIELD_UINT | 4:    field_store32(p, swap, n); break;
+    case FIELD_INT | 8:
+    case FIELD_UINT | 8:    field_store64(p, swap, n); break;
+    case FIELD_FLOAT | 4:   f = d; memcpy(&u32, &f, 4); field_store32(p, swap, u32); break;
+    default:                memcpy(&u64, &d, 8); field_store64(p, swap, u64); break;
+    }
+}
+
+// read*(offset), undefined is returned if out of range
+static val_t buffer_field_read(env_t *env, int ac, val_t *av, int kind, int be)
+{
+    int off = 0, size = FIELD_SIZE(kind);
+
+    (void) env;
+
+    if (ac < 1 || !val_is_buffer(av)) {
+        return VAL_UNDEFINED;
+    }
+    if (ac > 1 && val_is_number(av + 1)) {
+        off = val_2_integer(av + 1);
+    }
+    if (off < 0 || off > _val_buffer_size(av) - size) {
+        return VAL_UNDEFINED;
+    }
+
+    return val_mk_number(field_get((uint8_t *)_val_buffer_addr(av) + off, kind, be != (SYS_BYTE_ORDER == BE)));
+}
+
+// write*(value, offset), offset of next field is returned, or 0 if out of range
+static val_t buffer_field_write(env_t *env, int ac, val_t *av, int kind, int be)
+{
+    int off = 0, size = FIELD_SIZE(kind);
+
+    (void) env;
+
+    if (ac < 2 || !val_is_buffer(av) || !val_is_number(av + 1)) {
+        return val_mk_number(0);
+    }
+    if (ac > 2 && val_is_number(av + 2)) {
+        off = val_2_integer(av + 2);
+    }
+    if (off < 0 || off > _val_buffer_size(av) - size) {
+        return val_mk_number(0);
+    }
+
+    field_set((uint8_t *)_val_buffer_addr(av) + off, kind, be != (SYS_BYTE_ORDER == BE), val_2_double(av + 1));
+    return val_mk_number(off + size);
+}
+
+#define BUFFER_FIELD_NATIVE(name, kind, be)                             \
+val_t buffer_native_read_##name(env_t *env, int ac, val_t *av) {        \
+    return buffer_field_read(env, ac, av, kind, be);                    \
+}                                                                       \
+val_t buffer_native_write_##name(env_t *env, int ac, val_t *av) {       \
+    return buffer_field_write(env, ac, av, kind, be);                   \
+}
+
+BUFFER_FIELD_NATIVE(int8,       FIELD_INT | 1,   0)
+BUFFER_FIELD_NATIVE(uint8,      FIELD_UINT | 1,  0)
+BUFFER_FIELD_NATIVE(int16_le,   FIELD_INT | 2,   0)
+BUFFER_FIELD_NATIVE(int16_be,   FIELD_INT | 2,   1)
+BUFFER_FIELD_NATIVE(uint16_le,  FIELD_UINT | 2,  0)
+BUFFER_FIELD_NATIVE(uint16_be,  FIELD_UINT | 2,  1)
+BUFFER_FIELD_NATIVE(int32_le,   FIELD_INT | 4,   0)
+BUFFER_FIELD_NATIVE(int32_be,   FIELD_INT | 4,   1)
+BUFFER_FIELD_NATIVE(uint32_le,  FIELD_UINT | 4,  0)
+BUFFER_FIELD_NATIVE(uint32_be,  FIELD_UINT | 4,  1)
+BUFFER_FIELD_NATIVE(float32_le, FIELD_FLOAT | 4, 0)
+BUFFER_FIELD_NATIVE(float32_be, FIELD_FLOAT | 4, 1)
+BUFFER_FIELD_NATIVE(float64_le, FIELD_FLOAT | 8, 0)
+BUFFER_FIELD_NATIVE(float64_be, FIELD_FLOAT | 8, 1)
+
+/*
+ * Format of batched fields: [<|>|!] { [count] code }
+ *   x: pad byte, b/B: int8/uint8, h/H: 16 bits, i/I: 32 bits, q/Q: 64 bits,
+ *   f: float32, d: float64. The upper case ones are unsigned.
+ * Little endian is default, '>' and '!' mean big endian.
+ */
+static const char *buffer_format_order(const char *fmt, int *be)
+{
+    *be = 0;
+    if (*fmt == '<') {
+        fmt++;
+    } else
+    if (*fmt == '>' || *fmt == '!') {
+        *be = 1;
+        fmt++;
+    }
+    return fmt;
+}
+
+static const char *buffer_format_item(const char *fmt, int *count, int *kind)
+{
+    int n = -1;
+
+    while (*fmt >= '0' && *fmt <= '9') {
+        n = (n < 0 ? 0 : n * 10) + (*fmt++ - '0');
+        if (n > BUFFER_SIZE_MAX / 8) {
+            return NULL;
+        }
+    }
+    *count = n < 0 ? 1 : n;
+
+    switch (*fmt++) {
+    case 'x': *kind = FIELD_PAD; break;
+    case 'b': *kind = FIELD_INT | 1; break;
+    case 'B': *kind = FIELD_UINT | 1; break;
+    case 'h': *kind = FIELD_INT | 2; break;
+    case 'H': *kind = FIELD_UINT | 2; break;
+    case 'i': *kind = FIELD_INT | 4; break;
+    case 'I': *kind = FIELD_UINT | 4; break;
+    case 'q': *kind = FIELD_INT | 8; break;
+    case 'Q': *kind = FIELD_UINT | 8; break;
+    case 'f': *kind = FIELD_FLOAT | 4; break;
+    case 'd': *kind = FIELD_FLOAT | 8; break;
+    default:  return NULL;
+    }
+    return fmt;
+}
+
+// Count the fields and bytes of format, -1 is returned if it's invalid
+static int buffer_format_scan(const char *fmt, int *fields, int *bytes)
+{
+    int count, kind;
+
+    *fields = 0;
+    *bytes = 0;
+    while (*fmt) {
+        if (!(fmt = buffer_format_item(fmt, &count, &kind))) {
+            return -1;
+        }
+        *bytes += count * FIELD_SIZE(kind);
+        if (*bytes > BUFFER_SIZE_MAX / 2) {
+            return -1;
+        }
+        if (kind != FIELD_PAD) {
+            *fields += count;
+        }
+    }
+    return 0;
+}
+
+static int buffer_format_parse(env_t *env, int ac, val_t *av, int *be, int *off, int *fields)
+{
+    const char *fmt;
+    int bytes;
+
+    if (ac < 2 || !val_is_buffer(av) || !(fmt = val_2_cstring(av + 1))) {
+        env_set_error(env, ERR_InvalidInput);
+        return -1;
+    }
+    if (buffer_format_scan(buffer_format_order(fmt, be), fields, &bytes)) {
+        env_set_error(env, ERR_InvalidInput);
+        return -1;
+    }
+    if (*off < 0 || *off > _val_buffer_size(av) - bytes) {
+        return -1;
+    }
+    return 0;
+}
+
+// unpack(format[, offset]), fields are decoded into an array, undefined if out of range
+val_t buffer_native_unpack(env_t *env, int ac, val_t *av)
+{
+    const char *fmt;
+    uint8_t *p;
+    val_t *elems;
+    array_t *a;
+    int be, off = 0, fields, count, kind, swap, i;
+
+    if (ac > 2 && val_is_number(av + 2)) {
+        off = val_2_integer(av + 2);
+    }
+    if (buffer_format_parse(env, ac, av, &be, &off, &fields)) {
+        return VAL_UNDEFINED;
+    }
+
+    if (!(a = _array_create(env, fields))) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return VAL_UNDEFINED;
+    }
+
+    // defence GC
+    fmt = buffer_format_order(val_2_cstring(av + 1), &be);
+    p = (uint8_t *)_val_buffer_addr(av) + off;
+    elems = a->elems;
+    swap = be != (SYS_BYTE_ORDER == BE);
+    while (*fmt) {
+        fmt = buffer_format_item(fmt, &count, &kind);
+        if (kind == FIELD_PAD) {
+            p += count;
+            continue;
+        }
+        for (i = 0; i < count; i++, p += FIELD_SIZE(kind)) {
+            val_set_number(elems++, field_get(p, kind, swap));
+        }
+    }
+    a->elems_kind = ARRAY_ELEMS_NUMBER;
+
+    return val_mk_array(a);
+}
+
+// pack(format, values[, offset]), offset of next field is returned, or 0 if failed
+val_t buffer_native_pack(env_t *env, int ac, val_t *av)
+{
+    const char *fmt;
+    uint8_t *p;
+    val_t *elems;
+    array_t *a;
+    int be, off = 0, fields, count, kind, swap, i;
+
+    if (ac > 3 && val_is_number(av + 3)) {
+        off = val_2_integer(av + 3);
+    }
+    if (buffer_format_parse(env, ac, av, &be, &off, &fields)) {
+        return val_mk_number(0);
+    }
+    if (ac < 3 || !val_is_array(av + 2) || array_len(a = (array_t *)val_2_intptr(av + 2)) < fields) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_number(0);
+    }
+
+    fmt = buffer_format_order(val_2_cstring(av + 1), &be);
+    p = (uint8_t *)_val_buffer_addr(av) + off;
+    elems = array_values(a);
+    swap = be != (SYS_BYTE_ORDER == BE);
+    while (*fmt) {
+        fmt = buffer_format_item(fmt, &count, &kind);
+        if (kind == FIELD_PAD) {
+            memset(p, 0, count);
+            p += count;
+            continue;
+        }
+        for (i = 0; i < count; i++, p += FIELD_SIZE(kind), elems++) {
+            field_set(p, kind, swap, val_is_number(elems) ? val_2_double(elems) : 0);
+        }
+    }
+
+    return val_mk_number(p - (uint8_t *)_val_buffer_addr(av));
+}
+
+static inline uint32_t buffer_checksum_init(int ac, val_t *av, uint32_t init)
+{
+    double d = (ac > 3 && val_is_number(av + 3)) ? val_2_double(av + 3) : -1;
+
+    return (d >= 0 && d < 4294967296.0) ? (uint32_t) d : init;
+}
+
+/*
+ * crc32([start[, end[, crc]]]) and others, checksum of bytes in range.
+ * The last argument is result of previous bytes, to continue the calculation.
+ */
+static val_t buffer_checksum(env_t *env, int ac, val_t *av,
+                             uint32_t (*sum)(uint32_t, const void *, int), uint32_t init)
+{
+    int start, size;
+
+    if (buffer_range_parse(env, ac, av, &start, &size)) {
+        return VAL_UNDEFINED;
+    }
+    buffer_range_fix((type_buffer_t *) val_2_intptr(av), &start, &size);
+
+    init = buffer_checksum_init(ac, av, init);
+    return val_mk_number(sum(init, (uint8_t *)_val_buffer_addr(av) + start, size));
+}
+
+val_t buffer_native_crc32(env_t *env, int ac, val_t *av)
+{
+    return buffer_checksum(env, ac, av, checksum_crc32, CHECKSUM_CRC32_INIT);
+}
+
+val_t buffer_native_crc32c(env_t *env, int ac, val_t *av)
+{
+    return buffer_checksum(env, ac, av, checksum_crc32c, CHECKSUM_CRC32_INIT);
+}
+
+val_t buffer_native_adler32(env_t *env, int ac, val_t *av)
+{
+    return buffer_checksum(env, ac, av, checksum_adler32, CHECKSUM_ADLER32_INIT);
+}
+
+val_t buffer_native_fnv1a(env_t *env, int ac, val_t *av)
+{
+    return buffer_checksum(env, ac, av, checksum_fnv1a, CHECKSUM_FNV1A_INIT);
+}
+
+// xxhash64([start[, end[, seed]]]), 64 bits hash is returned as 16 hex digits
+val_t buffer_native_xxhash64(env_t *env, int ac, val_t *av)
+{
+    static const char hex[] = "0123456789abcdef";
+    uint64_t seed = 0, h;
+    int start, size, i;
+    char *str;
+    val_t s;
+
+    if (buffer_range_parse(env, ac, av, &start, &size)) {
+        return VAL_UNDEFINED;
+    }
+    buffer_range_fix((type_buffer_t *) val_2_intptr(av), &start, &size);
+
+    if (ac > 3 && val_is_number(av + 3)) {
+        double d = val_2_double(av + 3);
+        seed = (d >= 0 && d < 1.8e19) ? (uint64_t) d : 0;
+    }
+    h = checksum_xxhash64(seed, (uint8_t *)_val_buffer_addr(av) + start, size);
+
+    s = string_create_heap_val(env, 16);
+    if (!(str = (char *)val_2_cstring(&s))) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return VAL_UNDEFINED;
+    }
+    for (i = 15; i >= 0; i--, h >>= 4) {
+        str[i] = hex[h & 0xf];
+    }
+
+    return s;
+}
+
+void buffer_elem_get(void *env, val_t *self, int index, val_t *elem)
 {
     type_buffer_t *buf;
 
+    (void) env;
     buf = (type_buffer_t *)val_2_intptr(self);
-    if (index >= 0 && index < buf->len) {
-        val_set_number(elem, buf->buf[index]);
+    if (index >= 0 && index < _buffer_size(buf)) {
+        val_set_number(elem, ((uint8_t *)_buffer_addr(buf))[index]);
     } else {
         val_set_undefined(elem);
     }
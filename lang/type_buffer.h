@@ -31,27 +31,108 @@ SOFTWARE.
 #include "env.h"
 
 #define MAGIC_BUFFER        (MAGIC_BASE + 13)
+#define MAGIC_BUFFER_SLICE  (MAGIC_BASE + 25)
+#define MAGIC_BUFFER_EXTERN (MAGIC_BASE + 27)
+#define BUFFER_SIZE_MAX     (INT32_MAX)
+
+// Bytes are 8 bytes aligned, to be viewed as any type of elements
 typedef struct type_buffer_t {
     uint8_t  magic;
     uint8_t  age;
-    uint16_t len;
+    uint8_t  reserved[2];
+    uint32_t len;
     uint8_t  buf[0];
 } type_buffer_t;
 
+/*
+ * Slice shares bytes [off, off + len) of parent, which is never a slice.
+ * Referenced by TAG_BUFFER value too, the head is same as type_buffer_t.
+ */
+typedef struct type_buffer_slice_t {
+    uint8_t  magic;
+    uint8_t  age;
+    uint8_t  reserved[2];
+    uint32_t len;
+    uint32_t off;
+    uint32_t reserved2;
+    val_t    parent;
+} type_buffer_slice_t;
+
+/*
+ * Bytes live out of heap (host memory, mmap'd region ...), only the head is
+ * moved by gc. release is called when the buffer is not reachable any more,
+ * or the env is deinited.
+ */
+typedef void (*buffer_release_t)(void *data, int len);
+typedef struct type_buffer_extern_t {
+    uint8_t  magic;
+    uint8_t  age;
+    uint8_t  reserved[2];
+    uint32_t len;
+    uint8_t  *data;
+    buffer_release_t release;
+    struct type_buffer_extern_t *next;  // list of external buffers, see env_extern_gc
+} type_buffer_extern_t;
+
+static inline
+int buffer_mem_space_of(int size) {
+    return SIZE_ALIGN(sizeof(type_buffer_t) + size);
+}
+
 static inline
 int buffer_mem_space(type_buffer_t *buf) {
-    return SIZE_ALIGN(sizeof(type_buffer_t) + buf->len);
+    return buffer_mem_space_of(buf->len);
+}
+
+static inline
+int buffer_mem_space_slice(void) {
+    return SIZE_ALIGN(sizeof(type_buffer_slice_t));
+}
+
+static inline
+int buffer_mem_space_extern(void) {
+    return SIZE_ALIGN(sizeof(type_buffer_extern_t));
+}
+
+static inline
+int buffer_is_slice(type_buffer_t *b) {
+    return b->magic == MAGIC_BUFFER_SLICE;
+}
+
+static inline
+int buffer_is_extern(type_buffer_t *b) {
+    return b->magic == MAGIC_BUFFER_EXTERN;
+}
+
+// Memory space of head in heap
+static inline
+int buffer_mem_space_head(type_buffer_t *b) {
+    return buffer_is_slice(b) ? buffer_mem_space_slice() :
+           buffer_is_extern(b) ? buffer_mem_space_extern() : buffer_mem_space(b);
 }
 
 type_buffer_t *buffer_create(env_t *env, int size);
-type_buffer_t *buffer_slice(env_t *env, type_buffer_t *b, int start, int size);
+type_buffer_t *buffer_slice(env_t *env, val_t *b, int start, int size);
+type_buffer_t *buffer_copy(env_t *env, val_t *b, int start, int size);
+type_buffer_t *buffer_create_extern(env_t *env, void *data, int len, buffer_release_t release);
+void buffer_extern_release_all(env_t *env);
 int buffer_read_int(type_buffer_t *b, int off, int size, int be, int *v);
 int buffer_write_int(type_buffer_t *b, int off, int size, int be, int num);
 
 static inline
 int   _buffer_size(type_buffer_t *b) {return b->len;}
 static inline
-void *_buffer_addr(type_buffer_t *b) {return b->buf;}
+void *_buffer_data(type_buffer_t *b) {
+    return buffer_is_extern(b) ? ((type_buffer_extern_t *) b)->data : b->buf;
+}
+static inline
+void *_buffer_addr(type_buffer_t *b) {
+    if (buffer_is_slice(b)) {
+        type_buffer_slice_t *slice = (type_buffer_slice_t *) b;
+        return (uint8_t *)_buffer_data((type_buffer_t *) val_2_intptr(&slice->parent)) + slice->off;
+    }
+    return _buffer_data(b);
+}
 
 val_t buffer_native_create(env_t *env, int ac, val_t *av);
 val_t buffer_native_write_int(env_t *env, int ac, val_t *av);
@@ -59,9 +140,37 @@ val_t buffer_native_write_uint(env_t *env, int ac, val_t *av);
 val_t buffer_native_read_int(env_t *env, int ac, val_t *av);
 val_t buffer_native_read_uint(env_t *env, int ac, val_t *av);
 val_t buffer_native_slice(env_t *env, int ac, val_t *av);
+val_t buffer_native_copy(env_t *env, int ac, val_t *av);
+val_t buffer_native_unpack(env_t *env, int ac, val_t *av);
+val_t buffer_native_pack(env_t *env, int ac, val_t *av);
+val_t buffer_native_crc32(env_t *env, int ac, val_t *av);
+val_t buffer_native_crc32c(env_t *env, int ac, val_t *av);
+val_t buffer_native_adler32(env_t *env, int ac, val_t *av);
+val_t buffer_native_fnv1a(env_t *env, int ac, val_t *av);
+val_t buffer_native_xxhash64(env_t *env, int ac, val_t *av);
+
+// read<Type>(offset) & write<Type>(value, offset), LE & BE is the byte order
+#define BUFFER_FIELD_DECLARE(name)                                      \
+val_t buffer_native_read_##name(env_t *env, int ac, val_t *av);         \
+val_t buffer_native_write_##name(env_t *env, int ac, val_t *av);
+
+BUFFER_FIELD_DECLARE(int8)
+BUFFER_FIELD_DECLARE(uint8)
+BUFFER_FIELD_DECLARE(int16_le)
+BUFFER_FIELD_DECLARE(int16_be)
+BUFFER_FIELD_DECLARE(uint16_le)
+BUFFER_FIELD_DECLARE(uint16_be)
+BUFFER_FIELD_DECLARE(int32_le)
+BUFFER_FIELD_DECLARE(int32_be)
+BUFFER_FIELD_DECLARE(uint32_le)
+BUFFER_FIELD_DECLARE(uint32_be)
+BUFFER_FIELD_DECLARE(float32_le)
+BUFFER_FIELD_DECLARE(float32_be)
+BUFFER_FIELD_DECLARE(float64_le)
+BUFFER_FIELD_DECLARE(float64_be)
 val_t buffer_native_to_string(env_t *env, int ac, val_t *av);
 
-void buffer_elem_get(val_t *self, int index, val_t *elem);
+void buffer_elem_get(void *env, val_t *self, int index, val_t *elem);
 
 static inline
 void *_val_buffer_addr(val_t *v) {
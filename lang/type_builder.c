@@ -0,0 +1,273 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "err.h"
+#include "type_number.h"
+#include "type_string.h"
+#include "type_buffer.h"
+#include "type_builder.h"
+
+static inline type_builder_t *builder_of(val_t *v) {
+    return (type_builder_t *) val_2_intptr(v);
+}
+
+static inline int builder_size(type_builder_t *b) {
+    return val_is_buffer(&b->buf) ? _val_buffer_size(&b->buf) : 0;
+}
+
+/*
+ * Make room for n more bytes, return the address to write.
+ * Storage is replaced by a double size one when it is full, self should be a GC root.
+ */
+static uint8_t *builder_reserve(env_t *env, val_t *self, int n)
+{
+    type_builder_t *b = builder_of(self);
+    int size = builder_size(b);
+    int need = b->len + n;
+
+    if (need > size) {
+        type_buffer_t *buf;
+
+        if (need > STRING_LEN_MAX) {
+            env_set_error(env, ERR_ResourceOutLimit);
+            return NULL;
+        }
+
+        for (size = size ? size * 2 : BUILDER_DEF_SIZE; size < need; size *= 2)
+            ;
+        if (size > STRING_LEN_MAX) {
+            size = STRING_LEN_MAX;
+        }
+
+        buf = buffer_create(env, size);
+        if (!buf) {
+            env_set_error(env, ERR_NotEnoughMemory);
+            return NULL;
+        }
+
+        // defence GC
+        b = builder_of(self);
+        if (b->len) {
+            memcpy(_buffer_addr(buf), _val_buffer_addr(&b->buf), b->len);
+        }
+        val_set_buffer(&b->buf, buf);
+    }
+
+    return (uint8_t *) _val_buffer_addr(&b->buf) + b->len;
+}
+
+static int builder_append(env_t *env, val_t *self, val_t *v)
+{
+    char num[NUMBER_STR_MAX];
+    const char *data = num;
+    uint8_t *dst;
+    int len;
+
+    if (val_is_number(v)) {
+        len = number_to_cstr(val_2_double(v), num);
+    } else
+    if (val_is_string(v)) {
+        if (!string_view(v, &len)) {
+            return -1;
+        }
+    } else
+    if (val_is_buffer(v)) {
+        len = _val_buffer_size(v);
+    } else {
+        return -1;
+    }
+
+    if (!(dst = builder_reserve(env, self, len))) {
+        return -1;
+    }
+
+    // defence GC
+    if (val_is_string(v)) {
+        data = string_view(v, &len);
+    } else
+    if (val_is_buffer(v)) {
+        data = _val_buffer_addr(v);
+    }
+
+    memcpy(dst, data, len);
+    builder_of(self)->len += len;
+
+    return 0;
+}
+
+/*
+ * StringBuilder([capacity | string])
+ * Builder and its storage are allocated at once.
+ */
+val_t builder_native_create(env_t *env, int ac, val_t *av)
+{
+    type_builder_t *b;
+    int size = 0, len = 0;
+
+    if (ac > 0) {
+        if (val_is_number(av)) {
+            size = val_2_integer(av);
+        } else
+        if (val_is_string(av)) {
+            string_view(av, &len);
+            size = len;
+        }
+    }
+    if (size < 0 || size > STRING_LEN_MAX) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    if (!env_heap_reserve(env, builder_mem_space() + (size ? buffer_mem_space_of(size) : 0))) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return VAL_UNDEFINED;
+    }
+
+    b = env_heap_alloc(env, builder_mem_space());
+    b->magic = MAGIC_BUILDER;
+    b->age = 0;
+    b->len = 0;
+    b->reserved = 0;
+    val_set_undefined(&b->buf);
+
+    if (size) {
+        type_buffer_t *buf = buffer_create(env, size);
+
+        if (len) {
+            memcpy(_buffer_addr(buf), string_view(av, &len), len);
+            b->len = len;
+        }
+        val_set_buffer(&b->buf, buf);
+    }
+
+    return val_mk_builder(b);
+}
+
+// Append strings, numbers or buffers, return the builder itself
+val_t builder_native_append(env_t *env, int ac, val_t *av)
+{
+    int i;
+
+    if (ac < 1 || !val_is_builder(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    for (i = 1; i < ac; i++) {
+        if (0 != builder_append(env, av, av + i)) {
+            if (!env->error) {
+                env_set_error(env, ERR_InvalidInput);
+            }
+            return VAL_UNDEFINED;
+        }
+    }
+
+    return *av;
+}
+
+// Append a character by code or the first character of string
+val_t builder_native_append_char(env_t *env, int ac, val_t *av)
+{
+    uint8_t *dst;
+    int ch;
+
+    if (ac < 2 || !val_is_builder(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    if (val_is_number(av + 1)) {
+        ch = val_2_integer(av + 1);
+    } else {
+        int len;
+        const char *s = string_view(av + 1, &len);
+
+        if (!s || !len) {
+            env_set_error(env, ERR_InvalidInput);
+            return VAL_UNDEFINED;
+        }
+        ch = *s;
+    }
+
+    if (!(dst = builder_reserve(env, av, 1))) {
+        return VAL_UNDEFINED;
+    }
+    *dst = ch;
+    builder_of(av)->len++;
+
+    return *av;
+}
+
+// Text is dropped, storage is kept for reuse
+val_t builder_native_clear(env_t *env, int ac, val_t *av)
+{
+    if (ac < 1 || !val_is_builder(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    builder_of(av)->len = 0;
+
+    return *av;
+}
+
+val_t builder_native_length(env_t *env, int ac, val_t *av)
+{
+    if (ac < 1 || !val_is_builder(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    return val_mk_number(builder_of(av)->len);
+}
+
+val_t builder_native_to_string(env_t *env, int ac, val_t *av)
+{
+    int len;
+    val_t s;
+
+    if (ac < 1 || !val_is_builder(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    len = builder_of(av)->len;
+    if (len <= VAL_INLINE_STRING_MAX) {
+        const char *data = len ? _val_buffer_addr(&builder_of(av)->buf) : "";
+
+        val_set_inline_string(&s, data, len);
+        return s;
+    }
+
+    s = string_create_heap_val(env, len);
+    if (val_is_undefined(&s)) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return VAL_UNDEFINED;
+    }
+
+    // defence GC
+    memcpy((char *)val_2_cstring(&s), _val_buffer_addr(&builder_of(av)->buf), len);
+
+    return s;
+}
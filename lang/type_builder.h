@@ -0,0 +1,61 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __LANG_TYPE_BUILDER_INC__
+#define __LANG_TYPE_BUILDER_INC__
+
+#include "config.h"
+
+#include "val.h"
+#include "env.h"
+
+#define MAGIC_BUILDER       (MAGIC_BASE + 21)
+
+// Initial storage size of builder, doubled as needed
+#define BUILDER_DEF_SIZE    16
+
+/*
+ * Mutable text accumulator, referenced by TAG_BUILDER value.
+ * Text is kept in a buffer value, replaced by a larger one when it is full.
+ */
+typedef struct type_builder_t {
+    uint8_t  magic;
+    uint8_t  age;
+    uint16_t len;                       // bytes used in buf
+    uint32_t reserved;
+    val_t    buf;                       // buffer, or undefined if no text ever
+} type_builder_t;
+
+static inline int builder_mem_space(void) {
+    return SIZE_ALIGN(sizeof(type_builder_t));
+}
+
+val_t builder_native_create(env_t *env, int ac, val_t *av);
+val_t builder_native_append(env_t *env, int ac, val_t *av);
+val_t builder_native_append_char(env_t *env, int ac, val_t *av);
+val_t builder_native_clear(env_t *env, int ac, val_t *av);
+val_t builder_native_length(env_t *env, int ac, val_t *av);
+val_t builder_native_to_string(env_t *env, int ac, val_t *av);
+
+#endif /* __LANG_TYPE_BUILDER_INC__ */
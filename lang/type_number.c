@@ -22,16 +22,768 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "err.h"
 #include "val.h"
 #include "type_string.h"
+#include "type_buffer.h"
 #include "type_number.h"
 
+/*
+ * Shortest text of double, by Grisu2 (Florian Loitsch, "Printing Floating-Point
+ * Numbers Quickly and Accurately with Integers"). The digits always read back
+ * to the same double, and they are the shortest ones in nearly all cases.
+ */
+typedef struct diy_fp_t {
+    uint64_t f;
+    int      e;
+} diy_fp_t;
+
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_HIDDEN_BIT       0x0010000000000000ULL
+#define DP_EXPONENT_BIAS    (0x3FF + 52)
+
+// 10^k normalized, k = -348, -340, ..., 340
+static const diy_fp_t cached_powers[] = {
+    {0xfa8fd5a0081c0288ULL, -1220}, {0xbaaee17fa23ebf76ULL, -1193}, {0x8b16fb203055ac76ULL, -1166},
+    {0xcf42894a5dce35eaULL, -1140}, {0x9a6bb0aa55653b2dULL, -1113}, {0xe61acf033d1a45dfULL, -1087},
+    {0xab70fe17c79ac6caULL, -1060}, {0xff77b1fcbebcdc4fULL, -1034}, {0xbe5691ef416bd60cULL, -1007},
+    {0x8dd01fad907ffc3cULL, -980}, {0xd3515c2831559a83ULL, -954}, {0x9d71ac8fada6c9b5ULL, -927},
+    {0xea9c227723ee8bcbULL, -901}, {0xaecc49914078536dULL, -874}, {0x823c12795db6ce57ULL, -847},
+    {0xc21094364dfb5637ULL, -821}, {0x9096ea6f3848984fULL, -794}, {0xd77485cb25823ac7ULL, -768},
+    {0xa086cfcd97bf97f4ULL, -741}, {0xef340a98172aace5ULL, -715}, {0xb23867fb2a35b28eULL, -688},
+    {0x84c8d4dfd2c63f3bULL, -661}, {0xc5dd44271ad3cdbaULL, -635}, {0x936b9fcebb25c996ULL, -608},
+    {0xdbac6c247d62a584ULL, -582}, {0xa3ab66580d5fdaf6ULL, -555}, {0xf3e2f893dec3f126ULL, -529},
+    {0xb5b5ada8aaff80b8ULL, -502}, {0x87625f056c7c4a8bULL, -475}, {0xc9bcff6034c13053ULL, -449},
+    {0x964e858c91ba2655ULL, -422}, {0xdff9772470297ebdULL, -396}, {0xa6dfbd9fb8e5b88fULL, -369},
+    {0xf8a95fcf88747d94ULL, -343}, {0xb94470938fa89bcfULL, -316}, {0x8a08f0f8bf0f156bULL, -289},
+    {0xcdb02555653131b6ULL, -263}, {0x993fe2c6d07b7facULL, -236}, {0xe45c10c42a2b3b06ULL, -210},
+    {0xaa242499697392d3ULL, -183}, {0xfd87b5f28300ca0eULL, -157}, {0xbce5086492111aebULL, -130},
+    {0x8cbccc096f5088ccULL, -103}, {0xd1b71758e219652cULL, -77}, {0x9c40000000000000ULL, -50},
+    {0xe8d4a51000000000ULL, -24}, {0xad78ebc5ac620000ULL, 3}, {0x813f3978f8940984ULL, 30},
+    {0xc097ce7bc90715b3ULL, 56}, {0x8f7e32ce7bea5c70ULL, 83}, {0xd5d238a4abe98068ULL, 109},
+    {0x9f4f2726179a2245ULL, 136}, {0xed63a231d4c4fb27ULL, 162}, {0xb0de65388cc8ada8ULL, 189},
+    {0x83c7088e1aab65dbULL, 216}, {0xc45d1df942711d9aULL, 242}, {0x924d692ca61be758ULL, 269},
+    {0xda01ee641a708deaULL, 295}, {0xa26da3999aef774aULL, 322}, {0xf209787bb47d6b85ULL, 348},
+    {0xb454e4a179dd1877ULL, 375}, {0x865b86925b9bc5c2ULL, 402}, {0xc83553c5c8965d3dULL, 428},
+    {0x952ab45cfa97a0b3ULL, 455}, {0xde469fbd99a05fe3ULL, 481}, {0xa59bc234db398c25ULL, 508},
+    {0xf6c69a72a3989f5cULL, 534}, {0xb7dcbf5354e9beceULL, 561}, {0x88fcf317f22241e2ULL, 588},
+    {0xcc20ce9bd35c78a5ULL, 614}, {0x98165af37b2153dfULL, 641}, {0xe2a0b5dc971f303aULL, 667},
+    {0xa8d9d1535ce3b396ULL, 694}, {0xfb9b7cd9a4a7443cULL, 720}, {0xbb764c4ca7a44410ULL, 747},
+    {0x8bab8eefb6409c1aULL, 774}, {0xd01fef10a657842cULL, 800}, {0x9b10a4e5e9913129ULL, 827},
+    {0xe7109bfba19c0c9dULL, 853}, {0xac2820d9623bf429ULL, 880}, {0x80444b5e7aa7cf85ULL, 907},
+    {0xbf21e44003acdd2dULL, 933}, {0x8e679c2f5e44ff8fULL, 960}, {0xd433179d9c8cb841ULL, 986},
+    {0x9e19db92b4e31ba9ULL, 1013}, {0xeb96bf6ebadf77d9ULL, 1039}, {0xaf87023b9bf0ee6bULL, 1066}
+};
+
+static const uint64_t pow10_tbl[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static inline diy_fp_t diy_fp_of(double d) {
+    union { double d; uint64_t u; } u = { d };
+    int biased_e = (int) ((u.u >> 52) & 0x7FF);
+    diy_fp_t v;
+
+    v.f = u.u & DP_SIGNIFICAND_MASK;
+    if (biased_e) {
+        v.f += DP_HIDDEN_BIT;
+        v.e = biased_e - DP_EXPONENT_BIAS;
+    } else {
+        v.e = 1 - DP_EXPONENT_BIAS;
+    }
+    return v;
+}
+
+static inline diy_fp_t diy_fp_normalize(diy_fp_t v) {
+    while (!(v.f & 0x8000000000000000ULL)) {
+        v.f <<= 1;
+        v.e--;
+    }
+    return v;
+}
+
+// Upper 64 bits of product, rounded
+static inline diy_fp_t diy_fp_mul(diy_fp_t x, diy_fp_t y) {
+    uint64_t a = x.f >> 32, b = x.f & 0xFFFFFFFF;
+    uint64_t c = y.f >> 32, d = y.f & 0xFFFFFFFF;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF) + (1U << 31);
+    diy_fp_t r;
+
+    r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+    r.e = x.e + y.e + 64;
+    return r;
+}
+
+// Boundaries m- and m+ of v, with the same exponent
+static void diy_fp_boundaries(diy_fp_t v, diy_fp_t *mi, diy_fp_t *pl)
+{
+    diy_fp_t p, m;
+
+    p.f = (v.f << 1) + 1;
+    p.e = v.e - 1;
+    while (!(p.f & (DP_HIDDEN_BIT << 1))) {
+        p.f <<= 1;
+        p.e--;
+    }
+    p.f <<= 10;
+    p.e -= 10;
+
+    if (v.f == DP_HIDDEN_BIT) {
+        m.f = (v.f << 2) - 1;
+        m.e = v.e - 2;
+    } else {
+        m.f = (v.f << 1) - 1;
+        m.e = v.e - 1;
+    }
+    m.f <<= m.e - p.e;
+    m.e = p.e;
+
+    *mi = m;
+    *pl = p;
+}
+
+// Cached power c, let the exponent of e * c in [-60, -32], 10^k = 1 / c
+static inline diy_fp_t cached_power(int e, int *k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int n = (int) dk;
+    int index;
+
+    if (n != dk) {
+        n++;
+    }
+    index = (n >> 3) + 1;
+    *k = -(-348 + index * 8);
+
+    return cached_powers[index];
+}
+
+static inline int count_digits(uint32_t n) {
+    int i;
+
+    for (i = 1; i < 10 && n >= pow10_tbl[i]; i++)
+        ;
+    return i;
+}
+
+static inline void grisu_round(char *buf, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buf[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static int grisu_digits(diy_fp_t w, diy_fp_t mp, uint64_t delta, char *buf, int *k)
+{
+    int shift = -mp.e;
+    uint64_t one = 1ULL << shift;
+    uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t) (mp.f >> shift);
+    uint64_t p2 = mp.f & (one - 1);
+    int kappa = count_digits(p1);
+    int len = 0;
+
+    while (kappa > 0) {
+        uint32_t d = (uint32_t) (p1 / pow10_tbl[kappa - 1]);
+        uint64_t rest;
+
+        p1 %= pow10_tbl[kappa - 1];
+        if (d || len) {
+            buf[len++] = '0' + d;
+        }
+        kappa--;
+
+        rest = ((uint64_t) p1 << shift) + p2;
+        if (rest <= delta) {
+            *k += kappa;
+            grisu_round(buf, len, delta, rest, pow10_tbl[kappa] << shift, wp_w);
+            return len;
+        }
+    }
+
+    for (;;) {
+        uint32_t d;
+
+        p2 *= 10;
+        delta *= 10;
+        d = (uint32_t) (p2 >> shift);
+        if (d || len) {
+            buf[len++] = '0' + d;
+        }
+        p2 &= one - 1;
+        kappa--;
+
+        if (p2 < delta) {
+            *k += kappa;
+            grisu_round(buf, len, delta, p2, one, wp_w * pow10_tbl[-kappa]);
+            return len;
+        }
+    }
+}
+
+// Digits of positive d to buf, value is digits * 10^k
+static int grisu2(double d, char *buf, int *k)
+{
+    diy_fp_t v = diy_fp_of(d);
+    diy_fp_t mi, pl, c, w, wp, wm;
+
+    diy_fp_boundaries(v, &mi, &pl);
+    c = cached_power(pl.e, k);
+
+    w  = diy_fp_mul(diy_fp_normalize(v), c);
+    wp = diy_fp_mul(pl, c);
+    wm = diy_fp_mul(mi, c);
+    wm.f++;
+    wp.f--;
+
+    return grisu_digits(w, wp, wp.f - wm.f, buf, k);
+}
+
+static inline int exponent_to_cstr(int e, char *buf) {
+    int len = 0;
+
+    buf[len++] = 'e';
+    buf[len++] = e < 0 ? '-' : '+';
+    if (e < 0) {
+        e = -e;
+    }
+    if (e >= 100) {
+        buf[len++] = '0' + e / 100;
+        e %= 100;
+        buf[len++] = '0' + e / 10;
+    } else
+    if (e >= 10) {
+        buf[len++] = '0' + e / 10;
+    }
+    buf[len++] = '0' + e % 10;
+
+    return len;
+}
+
+/*
+ * Text of number to buf, return the length (without '\0').
+ * Integer is converted directly, others are the shortest digits laid out as javascript.
+ */
+int number_to_cstr(double d, char *buf)
+{
+    char digits[20];
+    int len = 0, n, k, i;
+
+    if (d != d) {
+        strcpy(buf, "NaN");
+        return 3;
+    }
+
+    if (d < 0) {
+        buf[len++] = '-';
+        d = -d;
+    }
+
+    if (d - d != 0) {
+        strcpy(buf + len, "Infinity");
+        return len + 8;
+    }
+
+    if (d < 9007199254740992.0 && d == (uint64_t) d) {
+        uint64_t u = (uint64_t) d;
+
+        i = 0;
+        do {
+            digits[i++] = '0' + u % 10;
+            u /= 10;
+        } while (u);
+
+        if (len && !d) {
+            // -0
+            len = 0;
+        }
+        while (i) {
+            buf[len++] = digits[--i];
+        }
+        buf[len] = 0;
+        return len;
+    }
+
+    n = grisu2(d, digits, &k);
+    // position of decimal point
+    k += n;
+
+    if (n <= k && k <= 21) {
+        memcpy(buf + len, digits, n);
+        len += n;
+        for (i = n; i < k; i++) {
+            buf[len++] = '0';
+        }
+    } else
+    if (0 < k && k <= 21) {
+        memcpy(buf + len, digits, k);
+        len += k;
+        buf[len++] = '.';
+        memcpy(buf + len, digits + k, n - k);
+        len += n - k;
+    } else
+    if (-6 < k && k <= 0) {
+        buf[len++] = '0';
+        buf[len++] = '.';
+        for (i = k; i < 0; i++) {
+            buf[len++] = '0';
+        }
+        memcpy(buf + len, digits, n);
+        len += n;
+    } else {
+        buf[len++] = digits[0];
+        if (n > 1) {
+            buf[len++] = '.';
+            memcpy(buf + len, digits + 1, n - 1);
+            len += n - 1;
+        }
+        len += exponent_to_cstr(k - 1, buf + len);
+    }
+    buf[len] = 0;
+
+    return len;
+}
+
+/*
+ * Number from decimal text, by the Clinger fast path and Eisel-Lemire
+ * (Daniel Lemire, "Number Parsing at a Gigabyte per Second").
+ * The rare cases which they could not decide exactly are left to strtod.
+ */
+#define POW10_MIN   (-64)
+#define POW10_MAX   (64)
+
+// 10^q normalized and truncated to 64 bits, q = POW10_MIN, ..., POW10_MAX
+static const uint64_t pow10_significand[] = {
+    0xa87fea27a539e9a5ULL, 0xd29fe4b18e88640eULL, 0x83a3eeeef9153e89ULL,
+    0xa48ceaaab75a8e2bULL, 0xcdb02555653131b6ULL, 0x808e17555f3ebf11ULL,
+    0xa0b19d2ab70e6ed6ULL, 0xc8de047564d20a8bULL, 0xfb158592be068d2eULL,
+    0x9ced737bb6c4183dULL, 0xc428d05aa4751e4cULL, 0xf53304714d9265dfULL,
+    0x993fe2c6d07b7fabULL, 0xbf8fdb78849a5f96ULL, 0xef73d256a5c0f77cULL,
+    0x95a8637627989aadULL, 0xbb127c53b17ec159ULL, 0xe9d71b689dde71afULL,
+    0x9226712162ab070dULL, 0xb6b00d69bb55c8d1ULL, 0xe45c10c42a2b3b05ULL,
+    0x8eb98a7a9a5b04e3ULL, 0xb267ed1940f1c61cULL, 0xdf01e85f912e37a3ULL,
+    0x8b61313bbabce2c6ULL, 0xae397d8aa96c1b77ULL, 0xd9c7dced53c72255ULL,
+    0x881cea14545c7575ULL, 0xaa242499697392d2ULL, 0xd4ad2dbfc3d07787ULL,
+    0x84ec3c97da624ab4ULL, 0xa6274bbdd0fadd61ULL, 0xcfb11ead453994baULL,
+    0x81ceb32c4b43fcf4ULL, 0xa2425ff75e14fc31ULL, 0xcad2f7f5359a3b3eULL,
+    0xfd87b5f28300ca0dULL, 0x9e74d1b791e07e48ULL, 0xc612062576589ddaULL,
+    0xf79687aed3eec551ULL, 0x9abe14cd44753b52ULL, 0xc16d9a0095928a27ULL,
+    0xf1c90080baf72cb1ULL, 0x971da05074da7beeULL, 0xbce5086492111aeaULL,
+    0xec1e4a7db69561a5ULL, 0x9392ee8e921d5d07ULL, 0xb877aa3236a4b449ULL,
+    0xe69594bec44de15bULL, 0x901d7cf73ab0acd9ULL, 0xb424dc35095cd80fULL,
+    0xe12e13424bb40e13ULL, 0x8cbccc096f5088cbULL, 0xafebff0bcb24aafeULL,
+    0xdbe6fecebdedd5beULL, 0x89705f4136b4a597ULL, 0xabcc77118461cefcULL,
+    0xd6bf94d5e57a42bcULL, 0x8637bd05af6c69b5ULL, 0xa7c5ac471b478423ULL,
+    0xd1b71758e219652bULL, 0x83126e978d4fdf3bULL, 0xa3d70a3d70a3d70aULL,
+    0xccccccccccccccccULL, 0x8000000000000000ULL, 0xa000000000000000ULL,
+    0xc800000000000000ULL, 0xfa00000000000000ULL, 0x9c40000000000000ULL,
+    0xc350000000000000ULL, 0xf424000000000000ULL, 0x9896800000000000ULL,
+    0xbebc200000000000ULL, 0xee6b280000000000ULL, 0x9502f90000000000ULL,
+    0xba43b74000000000ULL, 0xe8d4a51000000000ULL, 0x9184e72a00000000ULL,
+    0xb5e620f480000000ULL, 0xe35fa931a0000000ULL, 0x8e1bc9bf04000000ULL,
+    0xb1a2bc2ec5000000ULL, 0xde0b6b3a76400000ULL, 0x8ac7230489e80000ULL,
+    0xad78ebc5ac620000ULL, 0xd8d726b7177a8000ULL, 0x878678326eac9000ULL,
+    0xa968163f0a57b400ULL, 0xd3c21bcecceda100ULL, 0x84595161401484a0ULL,
+    0xa56fa5b99019a5c8ULL, 0xcecb8f27f4200f3aULL, 0x813f3978f8940984ULL,
+    0xa18f07d736b90be5ULL, 0xc9f2c9cd04674edeULL, 0xfc6f7c4045812296ULL,
+    0x9dc5ada82b70b59dULL, 0xc5371912364ce305ULL, 0xf684df56c3e01bc6ULL,
+    0x9a130b963a6c115cULL, 0xc097ce7bc90715b3ULL, 0xf0bdc21abb48db20ULL,
+    0x96769950b50d88f4ULL, 0xbc143fa4e250eb31ULL, 0xeb194f8e1ae525fdULL,
+    0x92efd1b8d0cf37beULL, 0xb7abc627050305adULL, 0xe596b7b0c643c719ULL,
+    0x8f7e32ce7bea5c6fULL, 0xb35dbf821ae4f38bULL, 0xe0352f62a19e306eULL,
+    0x8c213d9da502de45ULL, 0xaf298d050e4395d6ULL, 0xdaf3f04651d47b4cULL,
+    0x88d8762bf324cd0fULL, 0xab0e93b6efee0053ULL, 0xd5d238a4abe98068ULL,
+    0x85a36366eb71f041ULL, 0xa70c3c40a64e6c51ULL, 0xd0cf4b50cfe20765ULL,
+    0x82818f1281ed449fULL, 0xa321f2d7226895c7ULL, 0xcbea6f8ceb02bb39ULL,
+    0xfee50b7025c36a08ULL, 0x9f4f2726179a2245ULL, 0xc722f0ef9d80aad6ULL,
+    0xf8ebad2b84e0d58bULL, 0x9b934c3b330c8577ULL, 0xc2781f49ffcfa6d5ULL
+};
+
+static const double pow10_exact[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline int leading_zeros(uint64_t u) {
+#if defined(__GNUC__)
+    return __builtin_clzll(u);
+#else
+    int n = 0;
+
+    while (!(u & 0x8000000000000000ULL)) {
+        u <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Full product of a and b, return the low 64 bits
+static inline uint64_t mul_64x64(uint64_t a, uint64_t b, uint64_t *hi) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128) a * b;
+
+    *hi = (uint64_t) (r >> 64);
+    return (uint64_t) r;
+#else
+    uint64_t a_hi = a >> 32, a_lo = a & 0xFFFFFFFF;
+    uint64_t b_hi = b >> 32, b_lo = b & 0xFFFFFFFF;
+    uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (mid << 32) | (ll & 0xFFFFFFFF);
+#endif
+}
+
+// d = m * 10^q, return 0 if it could not be decided
+static int number_from_decimal(uint64_t m, int q, double *d)
+{
+    union { double d; uint64_t u; } u;
+    uint64_t factor, lower, upper, upperbit, mantissa;
+    int64_t exponent;
+    int lz;
+
+    if (m == 0) {
+        *d = 0;
+        return 1;
+    }
+
+    if (-22 <= q && q <= 22 && m <= 9007199254740992ULL) {
+        *d = (double) m;
+        if (q < 0) {
+            *d /= pow10_exact[-q];
+        } else {
+            *d *= pow10_exact[q];
+        }
+        return 1;
+    }
+
+    if (q < POW10_MIN || q > POW10_MAX) {
+        return 0;
+    }
+
+    factor = pow10_significand[q - POW10_MIN];
+    exponent = (((152170 + 65536) * (int64_t) q) >> 16) + 1024 + 63;
+
+    lz = leading_zeros(m);
+    m <<= lz;
+    lower = mul_64x64(m, factor, &upper);
+
+    // the truncated bits of factor may carry into the result
+    if ((upper & 0x1FF) == 0x1FF && lower + m < lower) {
+        return 0;
+    }
+
+    upperbit = upper >> 63;
+    mantissa = upper >> (upperbit + 9);
+    lz += (int) (1 ^ upperbit);
+
+    // halfway between two doubles
+    if (lower == 0 && (upper & 0x1FF) == 0 && (mantissa & 3) == 1) {
+        return 0;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (1ULL << 53)) {
+        mantissa = 1ULL << 52;
+        lz--;
+    }
+    mantissa &= ~(1ULL << 52);
+
+    exponent -= lz;
+    if (exponent < 1 || exponent > 2046) {
+        return 0;
+    }
+
+    u.u = mantissa | ((uint64_t) exponent << 52);
+    *d = u.d;
+
+    return 1;
+}
+
+/*
+ * By strtod, with a terminated copy of text.
+ * The too long one is rewritten as m * 10^q, with a sticky digit for the dropped ones.
+ */
+static double number_parse_slow(const char *s, int len, int neg, uint64_t m, int q, int truncated)
+{
+    char buf[128];
+
+    if (len < (int) sizeof(buf)) {
+        memcpy(buf, s, len);
+        buf[len] = 0;
+    } else {
+        snprintf(buf, sizeof(buf), "%s%llu%se%d", neg ? "-" : "", (unsigned long long) m,
+                 truncated ? "1" : "", truncated ? q - 1 : q);
+    }
+
+    return strtod(buf, NULL);
+}
+
+static inline int is_digit(int ch) {
+    return (unsigned) (ch - '0') < 10;
+}
+
+static inline int digit_value(int ch) {
+    if (is_digit(ch)) {
+        return ch - '0';
+    }
+    ch |= 0x20;
+    return ch >= 'a' && ch <= 'z' ? ch - 'a' + 10 : 36;
+}
+
+/*
+ * Parse number at the head of s (not terminated), [-+]digits[.digits][e[-+]digits] or 0x...
+ * Return the count of bytes used, 0 if there is no number.
+ */
+int number_parse(const char *s, int len, double *d)
+{
+    const char *p = s, *end = s + len, *mark;
+    uint64_t m = 0;
+    int neg = 0, n = 0, q = 0, truncated = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p++ == '-';
+    }
+
+    if (end - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x' && digit_value(p[2]) < 16) {
+        double v = 0;
+
+        for (p += 2; p < end && digit_value(*p) < 16; p++) {
+            v = v * 16 + digit_value(*p);
+        }
+        *d = neg ? -v : v;
+        return p - s;
+    }
+
+    mark = p;
+    while (p < end && *p == '0') {
+        p++;
+    }
+    for (; p < end && is_digit(*p); p++, n++) {
+        if (n < 19) {
+            m = m * 10 + (*p - '0');
+        } else {
+            truncated |= *p != '0';
+            q++;
+        }
+    }
+    if (p < end && *p == '.' && (p > mark || (p + 1 < end && is_digit(p[1])))) {
+        p++;
+        if (!n) {
+            for (; p < end && *p == '0'; p++) {
+                q--;
+            }
+        }
+        for (; p < end && is_digit(*p); p++, n++) {
+            if (n < 19) {
+                m = m * 10 + (*p - '0');
+                q--;
+            } else {
+                truncated |= *p != '0';
+            }
+        }
+    }
+    if (p == mark) {
+        return 0;
+    }
+
+    if (p < end && (*p | 0x20) == 'e') {
+        const char *e = p + 1;
+        int eneg = 0, ev = 0;
+
+        if (e < end && (*e == '-' || *e == '+')) {
+            eneg = *e++ == '-';
+        }
+        if (e < end && is_digit(*e)) {
+            for (; e < end && is_digit(*e); e++) {
+                if (ev < 100000) {
+                    ev = ev * 10 + (*e - '0');
+                }
+            }
+            q += eneg ? -ev : ev;
+            p = e;
+        }
+    }
+
+    // digits out of 19 are dropped, m and m + 1 should give the same one
+    if (number_from_decimal(m, q, d)) {
+        double next;
+
+        if (!truncated || (number_from_decimal(m + 1, q, &next) && next == *d)) {
+            *d = neg ? -*d : *d;
+            return p - s;
+        }
+    }
+
+    *d = number_parse_slow(s, p - s, neg, m, q, truncated);
+    return p - s;
+}
+
+// String value of number, short text is kept inline (may cause GC)
+val_t number_string_val(env_t *env, double d)
+{
+    char buf[NUMBER_STR_MAX];
+    int len = number_to_cstr(d, buf);
+    val_t s;
+
+    if (len <= VAL_INLINE_STRING_MAX) {
+        val_set_inline_string(&s, buf, len);
+        return s;
+    }
+
+    s = string_create_heap_val(env, len);
+    if (val_is_undefined(&s)) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return VAL_UNDEFINED;
+    }
+    memcpy((char *)val_2_cstring(&s), buf, len);
+
+    return s;
+}
+
 val_t number_to_string(env_t *env, int ac, val_t *av)
 {
+    if (ac < 1 || !val_is_number(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    return number_string_val(env, val_2_double(av));
+}
+
+
+static inline int is_space(int ch) {
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+// Text bytes of string or buffer, no copy
+static const char *number_text_of(val_t *v, int *len)
+{
+    const char *s = NULL;
+
+    if (val_is_string(v)) {
+        s = string_view(v, len);
+    } else
+    if (val_is_buffer(v)) {
+        s = (const char *) _val_buffer_addr(v);
+        *len = _val_buffer_size(v);
+    }
+
+    return s;
+}
+
+// parseInt(text[, radix])
+val_t number_native_parse_int(env_t *env, int ac, val_t *av)
+{
+    const char *s, *end;
+    uint64_t u = 0;
+    double d = 0;
+    int len, radix = 0, neg = 0, n = 0;
+
+    (void) env;
+
+    if (ac < 1 || !(s = number_text_of(av, &len))) {
+        return val_mk_nan();
+    }
+    if (ac > 1 && val_is_number(av + 1)) {
+        radix = val_2_integer(av + 1);
+        if (radix && (radix < 2 || radix > 36)) {
+            return val_mk_nan();
+        }
+    }
+
+    end = s + len;
+    while (s < end && is_space(*s)) {
+        s++;
+    }
+    if (s < end && (*s == '-' || *s == '+')) {
+        neg = *s++ == '-';
+    }
+    if ((!radix || radix == 16) && end - s > 1 && s[0] == '0' && (s[1] | 0x20) == 'x') {
+        radix = 16;
+        s += 2;
+    }
+    if (!radix) {
+        radix = 10;
+    }
+
+    // integer part is exact, until it is out of 2^53
+    for (; s < end && digit_value(*s) < radix; s++, n++) {
+        if (u < (1ULL << 53) / 36) {
+            u = u * radix + digit_value(*s);
+            d = (double) u;
+        } else {
+            d = d * radix + digit_value(*s);
+        }
+    }
+    if (!n) {
+        return val_mk_nan();
+    }
+
+    return val_mk_number(neg ? -d : d);
+}
+
+// parseFloat(text), leading number of text
+val_t number_native_parse_float(env_t *env, int ac, val_t *av)
+{
+    const char *s;
+    double d;
+    int len;
+
     (void) env;
-    (void) ac;
-    (void) av;
 
-    return val_mk_foreign_string((intptr_t)"<number>");
+    if (ac < 1 || !(s = number_text_of(av, &len))) {
+        return val_mk_nan();
+    }
+
+    while (len && is_space(*s)) {
+        s++;
+        len--;
+    }
+
+    return number_parse(s, len, &d) ? val_mk_number(d) : val_mk_nan();
 }
 
+// Number(value), whole text should be a number
+val_t number_native_create(env_t *env, int ac, val_t *av)
+{
+    const char *s;
+    double d = 0;
+    int len;
+
+    (void) env;
+
+    if (ac < 1) {
+        return val_mk_number(0);
+    }
+    if (val_is_number(av)) {
+        return *av;
+    }
+    if (val_is_boolean(av)) {
+        return val_mk_number(val_2_intptr(av) ? 1 : 0);
+    }
+    if (!(s = number_text_of(av, &len))) {
+        return val_mk_nan();
+    }
+
+    while (len && is_space(*s)) {
+        s++;
+        len--;
+    }
+    while (len && is_space(s[len - 1])) {
+        len--;
+    }
+
+    if (len && number_parse(s, len, &d) != len) {
+        return val_mk_nan();
+    }
+
+    return val_mk_number(d);
+}
@@ -31,6 +31,9 @@ SOFTWARE.
 #include "val.h"
 #include "env.h"
 
+// Size of buffer enough for any number text
+#define NUMBER_STR_MAX      32
+
 static inline void number_incp(val_t *a, val_t *res) {
     val_set_number(a, val_2_double(a) + 1);
     *res = *a;
@@ -131,7 +134,13 @@ static inline void number_rshift(val_t *a, val_t *b, val_t *res) {
     }
 }
 
+int number_to_cstr(double d, char *buf);
+int number_parse(const char *s, int len, double *d);
+val_t number_string_val(env_t *env, double d);
 val_t number_to_string(env_t *env, int ac, val_t *av);
+val_t number_native_parse_int(env_t *env, int ac, val_t *av);
+val_t number_native_parse_float(env_t *env, int ac, val_t *av);
+val_t number_native_create(env_t *env, int ac, val_t *av);
 
 #endif /* __LANG_NUMBER_INC__ */
 
@@ -33,7 +33,8 @@ static object_t object_proto;
 static intptr_t object_prop_keys[3] = {(intptr_t)"length", (intptr_t)"toString", (intptr_t)"foreach"};
 static val_t object_prop_vals[3];
 
-static val_t *object_add_prop(env_t *env, object_t *obj, intptr_t symbal) {
+static val_t *object_add_prop(env_t *env, val_t *self, intptr_t symbal) {
+    object_t *obj = (object_t *) val_2_intptr(self);
     val_t *vals;
     intptr_t *keys;
 
@@ -54,10 +55,13 @@ static val_t *object_add_prop(env_t *env, object_t *obj, intptr_t symbal) {
         }
         vals = (val_t *)(keys + size);
 
+        // defence GC
+        obj = (object_t *) val_2_intptr(self);
         memcpy(keys, obj->keys, sizeof(intptr_t) * obj->prop_num);
         memcpy(vals, obj->vals, sizeof(val_t) * obj->prop_num);
         obj->keys = keys;
         obj->vals = vals;
+        obj->prop_size = size;
     } else {
         vals = obj->vals;
         keys = obj->keys;
@@ -125,18 +129,27 @@ static val_t object_to_string(env_t *env, int ac, val_t *obj)
 static val_t object_foreach(env_t *env, int ac, val_t *av)
 {
     if (ac > 1 && val_is_object(av) && val_is_function(av + 1)) {
-        object_t *o = (object_t *)val_2_intptr(av);
-        int i, max = o->prop_num;
+        interp_callback_t cb;
+        int i;
+
+        if (interp_callback_prepare(env, &cb, av + 1, 2)) {
+            return val_mk_undefined();
+        }
 
-        for (i = 0; i < max && !env->error; i++) {
-            val_t key = val_mk_foreign_string(o->keys[i]);
+        for (i = 0; !env->error; i++) {
+            // defence GC, object may be moved or changed by callback
+            object_t *o = (object_t *)val_2_intptr(av);
 
-            env_push_call_argument(env, &key);
-            env_push_call_argument(env, o->vals + i);
-            env_push_call_function(env, av + 1);
+            if (i >= o->prop_num) {
+                break;
+            }
 
-            interp_execute_call(env, 2);
+            cb.av[0] = o->vals[i];
+            cb.av[1] = val_mk_foreign_string(o->keys[i]);
+            interp_callback_call(env, &cb);
         }
+
+        interp_callback_release(env, &cb);
     }
 
     return val_mk_undefined();
@@ -217,16 +230,20 @@ val_t *object_prop_ref(env_t *env, val_t *self, val_t *key)
     val_t *prop = NULL;
 
     if (name) {
-        intptr_t sym_id = env_symbal_get(env, name);
+        intptr_t sym_id = env_symbal_get_hashed(env, name, string_hash_of(env, key));
 
         if (sym_id) {
             prop = object_find_prop_owned(obj, sym_id);
             if (prop) {
                 return prop;
             }
-            prop = object_add_prop(env, obj, sym_id);
+            prop = object_add_prop(env, self, sym_id);
         } else {
-            prop = object_add_prop(env, obj, env_symbal_add(env, name));
+            sym_id = env_symbal_add_dynamic(env, key);
+            if (!sym_id) {
+                return NULL;
+            }
+            prop = object_add_prop(env, self, sym_id);
         }
 
         if (prop) {
@@ -247,7 +264,7 @@ void object_prop_val(env_t *env, val_t *self, val_t *key, val_t *prop)
     }
     obj = (object_t *) val_2_intptr(self);
     if (obj) {
-        val_t *v = object_find_prop(obj, env_symbal_get(env, name));
+        val_t *v = object_find_prop(obj, env_symbal_get_hashed(env, name, string_hash_of(env, key)));
         if (v) {
             *prop = *v;
         } else {
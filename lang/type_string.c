@@ -23,52 +23,167 @@ SOFTWARE.
 */
 
 #include "err.h"
+#include "hash.h"
+#include "bytes.h"
+#include "type_number.h"
 #include "type_string.h"
+#include "type_array.h"
 
 int string_compare(val_t *a, val_t *b)
 {
-    const char *s1 = val_2_cstring(a);
-    const char *s2 = val_2_cstring(b);
+    int l1, l2;
+    const char *s1 = string_view(a, &l1);
+    const char *s2 = string_view(b, &l2);
 
-    if (s1 && s2) {
-        return strcmp(s1, s2);
-    } else {
+    if (!s1 || !s2) {
         return 1;
     }
+
+    return bytes_compare(s1, l1, s2, l2);
+}
+
+int string_is_equal(val_t *a, val_t *b)
+{
+    if (val_is_inline_string(a) && val_is_inline_string(b)) {
+        return *a == *b;
+    } else
+    if (val_is_heap_string(a) && val_is_heap_string(b)) {
+        string_t *s1 = (string_t *) val_2_intptr(a);
+        string_t *s2 = (string_t *) val_2_intptr(b);
+
+        if (s1->magic == MAGIC_STRING && s2->magic == MAGIC_STRING) {
+            if (s1->interned && s2->interned) {
+                return s1 == s2;
+            }
+            if (s1->len != s2->len || (s1->hash && s2->hash && s1->hash != s2->hash)) {
+                return 0;
+            }
+            return bytes_is_equal(s1->str, s1->len, s2->str, s2->len);
+        }
+    }
+
+    return string_compare(a, b) == 0;
+}
+
+int string_length_of(env_t *env, val_t *v)
+{
+    if (val_is_foreign_string(v)) {
+        int i = executable_string_find(&env->exe, val_2_intptr(v));
+
+        if (i >= 0) {
+            return env->exe.string_lens[i];
+        }
+    }
+
+    return string_len(v);
+}
+
+// As string_view, but length of string constant is found in executable
+static const char *string_view_of(env_t *env, val_t *v, int *len)
+{
+    if (val_is_foreign_string(v)) {
+        *len = string_length_of(env, v);
+        return val_2_cstring(v);
+    }
+    return string_view(v, len);
+}
+
+// Rope and slice should be flattened before
+uint32_t string_hash_of(env_t *env, val_t *v)
+{
+    const char *str;
+
+    if (string_is_rope(v)) {
+        val_rope_t *rope = (val_rope_t *) val_2_intptr(v);
+
+        v = &rope->left;
+    }
+
+    if (val_is_heap_string(v) && ((string_t *) val_2_intptr(v))->magic == MAGIC_STRING) {
+        string_t *s = (string_t *) val_2_intptr(v);
+
+        if (!s->hash) {
+            s->hash = hash_fnv1a(s->str);
+        }
+        return s->hash;
+    } else
+    if (val_is_foreign_string(v)) {
+        int i = executable_string_find(&env->exe, val_2_intptr(v));
+
+        if (i >= 0) {
+            return env->exe.string_hashes[i];
+        }
+    }
+
+    str = val_2_cstring(v);
+    return str ? hash_fnv1a(str) : 0;
+}
+
+/*
+ * Replace v with the interned string of the same bytes, rope or slice is flattened.
+ * Inline and foreign string are not interned, nor when the intern table can not grow up.
+ */
+void string_intern(env_t *env, val_t *v)
+{
+    intptr_t s;
+
+    if (string_is_rope(v)) {
+        val_rope_t *rope = (val_rope_t *) val_2_intptr(v);
+
+        if (val_is_undefined(&rope->right)) {
+            *v = rope->left;
+        }
+    }
+
+    if ((string_is_rope(v) || string_is_slice(v)) && !string_heap_flatten(env, v)) {
+        return;
+    }
+
+    if (!val_is_heap_string(v)) {
+        return;
+    }
+
+    string_hash_of(env, v);
+    s = env_string_intern(env, v);
+    if (s) {
+        val_set_heap_string(v, s);
+    }
 }
 
 void string_at(env_t *env, val_t *a, val_t *b, val_t *res)
 {
-    const char *s = val_2_cstring(a);
-    int l = strlen(s);
+    int l;
+    const char *s = string_view_of(env, a, &l);
     int i = val_2_integer(b);
 
-    (void) env;
-    if (i >= 0 && i < l) {
+    if (s && i >= 0 && i < l) {
         val_set_inner_string(res, s[i]);
     } else {
         val_set_undefined(res);
     }
 }
 
-static inline string_t *string_alloc(env_t *env, int size)
+static inline string_t *string_alloc(env_t *env, int len)
 {
-    string_t *s = env_heap_alloc(env, SIZE_ALIGN(sizeof(string_t) + size));
+    string_t *s = env_heap_alloc(env, SIZE_ALIGN(sizeof(string_t) + len + 1));
 
     if (s) {
         s->magic = MAGIC_STRING;
         s->age = 0;
-        s->size = size;
+        s->size = len + 1;
+        s->len = len;
+        s->interned = 0;
+        s->hash = 0;
+        s->str[len] = 0;
     }
     return s;
 }
 
+// Characters should be filled by caller, all of the size
 val_t string_create_heap_val(env_t *env, int size)
 {
-    string_t *s;
+    string_t *s = string_alloc(env, size);
 
-    size += 1;
-    s = string_alloc(env, size);
     if (s) {
         memset(s->str, 0, size);
         return val_mk_heap_string((intptr_t)s);
@@ -76,35 +191,215 @@ val_t string_create_heap_val(env_t *env, int size)
     return VAL_UNDEFINED;
 }
 
+/*
+ * Copy string bytes to dst, without the tail '\0'.
+ * Recurse into the shorter side of a rope, the depth is bounded by log2(len).
+ */
+static void string_copy(char *dst, val_t *v)
+{
+    while (string_is_rope(v)) {
+        val_rope_t *rope = (val_rope_t *) val_2_intptr(v);
+        int l;
+
+        if (val_is_undefined(&rope->right)) {
+            v = &rope->left;
+            break;
+        }
+
+        l = string_len(&rope->left);
+        if (l * 2 <= (int)rope->len) {
+            string_copy(dst, &rope->left);
+            dst += l;
+            v = &rope->right;
+        } else {
+            string_copy(dst + l, &rope->right);
+            v = &rope->left;
+        }
+    }
+
+    if (val_is_string(v)) {
+        int l;
+        const char *s = string_view(v, &l);
+
+        memcpy(dst, s, l);
+    }
+}
+
+static val_rope_t *string_rope_alloc(env_t *env)
+{
+    val_rope_t *rope = env_heap_alloc(env, string_mem_space_rope());
+
+    if (rope) {
+        rope->magic = MAGIC_STRING_ROPE;
+        rope->age = 0;
+    }
+    return rope;
+}
+
+const char *string_heap_flatten(env_t *env, val_t *v)
+{
+    int len = string_len(v);
+    string_t *s = string_alloc(env, len);
+
+    if (!s) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return NULL;
+    }
+    // defence GC
+    string_copy(s->str, v);
+
+    // keep the result in rope or slice, for other references of it
+    if (string_is_rope(v)) {
+        val_rope_t *rope = (val_rope_t *) val_2_intptr(v);
+
+        val_set_heap_string(&rope->left, (intptr_t) s);
+        val_set_undefined(&rope->right);
+    } else {
+        val_slice_t *slice = (val_slice_t *) val_2_intptr(v);
+
+        val_set_heap_string(&slice->parent, (intptr_t) s);
+        slice->off = 0;
+        slice->end = len;
+    }
+    val_set_heap_string(v, (intptr_t) s);
+
+    return s->str;
+}
+
+/*
+ * a and b should be GC roots, res could be one of them.
+ * Number b is replaced by its text.
+ */
 void string_add(env_t *env, val_t *a, val_t *b, val_t *res)
 {
+    if (val_is_number(b)) {
+        *b = number_string_val(env, val_2_double(b));
+    }
     if (!val_is_string(b)) {
         val_set_nan(res);
         return;
     }
 
-    int size1 = string_len(a);
-    int size2 = string_len(b);
+    int size1 = string_length_of(env, a);
+    int size2 = string_length_of(env, b);
     int len = size1 + size2;
-    string_t *s = string_alloc(env, len + 1);
 
-    if (s) {
-        // Todo: length overflow should be check! or variable length field.
-        memcpy(s->str + 0, val_2_cstring(a), size1);
-        memcpy(s->str + size1, val_2_cstring(b), size2 + 1);
-        val_set_heap_string(res, (intptr_t) s);
+    if (len > STRING_LEN_MAX) {
+        env_set_error(env, ERR_ResourceOutLimit);
+        val_set_undefined(res);
+        return;
+    }
+
+    if (size2 == 0) {
+        *res = *a;
+    } else
+    if (size1 == 0) {
+        *res = *b;
+    } else
+    if (len <= VAL_INLINE_STRING_MAX) {
+        char buf[VAL_INLINE_STRING_MAX];
+
+        // res may be one of the operands
+        memcpy(buf, val_2_cstring(a), size1);
+        memcpy(buf + size1, val_2_cstring(b), size2);
+        val_set_inline_string(res, buf, len);
+    } else
+    if (len < STRING_ROPE_THRESHOLD) {
+        string_t *s = string_alloc(env, len);
+
+        if (s) {
+            string_copy(s->str, a);
+            string_copy(s->str + size1, b);
+            val_set_heap_string(res, (intptr_t) s);
+        } else {
+            env_set_error(env, ERR_NotEnoughMemory);
+            val_set_undefined(res);
+        }
     } else {
-        env_set_error(env, ERR_NotEnoughMemory);
+        val_rope_t *rope = string_rope_alloc(env);
+
+        if (rope) {
+            rope->len = len;
+            rope->left = *a;
+            rope->right = *b;
+            val_set_heap_string(res, (intptr_t) rope);
+        } else {
+            env_set_error(env, ERR_NotEnoughMemory);
+            val_set_undefined(res);
+        }
+    }
+}
+
+// Length of concatenate operand, number is counted as its text
+static inline int string_concat_len(env_t *env, val_t *v)
+{
+    if (val_is_number(v)) {
+        char buf[NUMBER_STR_MAX];
+
+        return number_to_cstr(val_2_double(v), buf);
+    }
+    return string_length_of(env, v);
+}
+
+static inline int string_concat_copy(env_t *env, char *dst, val_t *v)
+{
+    if (val_is_number(v)) {
+        char buf[NUMBER_STR_MAX];
+        int len = number_to_cstr(val_2_double(v), buf);
+
+        memcpy(dst, buf, len);
+        return len;
+    }
+    string_copy(dst, v);
+    return string_length_of(env, v);
+}
+
+/*
+ * Concatenate n strings (or numbers, as their text) at once,
+ * av[n - 1] is the first one (order of stack).
+ * Strings should be GC roots, res could be one of them.
+ */
+void string_concat(env_t *env, int n, val_t *av, val_t *res)
+{
+    int i, len = 0;
+
+    for (i = 0; i < n; i++) {
+        len += string_concat_len(env, av + i);
+    }
+
+    if (len > STRING_LEN_MAX) {
+        env_set_error(env, ERR_ResourceOutLimit);
         val_set_undefined(res);
+    } else
+    if (len <= VAL_INLINE_STRING_MAX) {
+        char buf[VAL_INLINE_STRING_MAX];
+
+        for (len = 0, i = n - 1; i >= 0; i--) {
+            len += string_concat_copy(env, buf + len, av + i);
+        }
+        val_set_inline_string(res, buf, len);
+    } else {
+        string_t *s = string_alloc(env, len);
+
+        if (s) {
+            // defence GC: operands are reloaded by string_copy
+            for (len = 0, i = n - 1; i >= 0; i--) {
+                len += string_concat_copy(env, s->str + len, av + i);
+            }
+            val_set_heap_string(res, (intptr_t) s);
+        } else {
+            env_set_error(env, ERR_NotEnoughMemory);
+            val_set_undefined(res);
+        }
     }
 }
 
-void string_elem_get(val_t *self, int i, val_t *elem)
+void string_elem_get(void *env, val_t *self, int i, val_t *elem)
 {
-    const char *s = val_2_cstring(self);
-    int len = string_len(self);
+    int len;
+    const char *s = string_view_of(env, self, &len);
 
-    if (i >= 0 && i < len) {
+    if (s && i >= 0 && i < len) {
         val_set_inner_string(elem, s[i]);
     } else {
         val_set_undefined(elem);
@@ -113,10 +408,8 @@ void string_elem_get(val_t *self, int i, val_t *elem)
 
 val_t string_length(env_t *env, int ac, val_t *av)
 {
-    (void) env;
-
     if (ac > 0) {
-        return val_mk_number(string_len(av));
+        return val_mk_number(string_length_of(env, av));
     } else {
         return val_mk_undefined();
     }
@@ -125,20 +418,291 @@ val_t string_length(env_t *env, int ac, val_t *av)
 val_t string_index_of(env_t *env, int ac, val_t *av)
 {
     const char *s, *f;
+    int len, flen, pos;
 
-    if (ac < 2 || NULL == (s = val_2_cstring(av))) {
+    if (ac < 2 || NULL == (s = string_view_of(env, av, &len))) {
         env_set_error(env, ERR_InvalidInput);
         return val_mk_undefined();
     } else
-    if (NULL == (f = val_2_cstring(av+1))) {
+    if (NULL == (f = string_view_of(env, av + 1, &flen))) {
         return val_mk_number(-1);
     } else {
-        char *pos = strstr(s, f);
-        if (pos)  {
-            return val_mk_number(pos - s);
+        int i;
+
+        pos = ac > 2 && val_is_number(av + 2) ? val_2_integer(av + 2) : 0;
+        if (pos < 0) {
+            pos = 0;
+        } else
+        if (pos > len) {
+            pos = len;
+        }
+
+        i = bytes_find(s + pos, len - pos, f, flen);
+        return val_mk_number(i < 0 ? -1 : pos + i);
+    }
+}
+
+
+/*
+ * Part of string v, v should be a GC root.
+ * Short part is copied, the longer one refers to the parent string of v.
+ */
+static val_t string_part(env_t *env, val_t *v, int off, int len)
+{
+    const char *s;
+    int total;
+    val_t res;
+
+    s = string_view_of(env, v, &total);
+    if (len <= VAL_INLINE_STRING_MAX) {
+        val_set_inline_string(&res, s + off, len);
+    } else
+    if (len == total) {
+        res = *v;
+    } else
+    if (len < STRING_SLICE_THRESHOLD) {
+        string_t *str = string_alloc(env, len);
+
+        if (!str) {
+            goto ERR;
+        }
+        // defence GC
+        s = string_view_of(env, v, &total);
+        memcpy(str->str, s + off, len);
+        val_set_heap_string(&res, (intptr_t) str);
+    } else {
+        val_slice_t *slice = env_heap_alloc(env, string_mem_space_slice());
+
+        if (!slice) {
+            goto ERR;
+        }
+        slice->magic = MAGIC_STRING_SLICE;
+        slice->age = 0;
+        slice->len = len;
+        slice->off = off;
+        slice->end = total;
+
+        // defence GC
+        if (string_is_slice(v)) {
+            val_slice_t *from = (val_slice_t *) val_2_intptr(v);
+
+            slice->off += from->off;
+            slice->end = from->end;
+            slice->parent = from->parent;
+        } else
+        if (string_is_rope(v)) {
+            slice->parent = ((val_rope_t *) val_2_intptr(v))->left;
         } else {
-            return val_mk_number(-1);
+            slice->parent = *v;
         }
+        val_set_heap_string(&res, (intptr_t) slice);
+    }
+    return res;
+
+ERR:
+    env_set_error(env, ERR_NotEnoughMemory);
+    return val_mk_undefined();
+}
+
+// Heap space of a string part, see string_part
+static int string_part_space(int len)
+{
+    if (len <= VAL_INLINE_STRING_MAX) {
+        return 0;
+    } else
+    if (len < STRING_SLICE_THRESHOLD) {
+        return SIZE_ALIGN(sizeof(string_t) + len + 1);
+    } else {
+        return string_mem_space_slice();
     }
 }
 
+// Position argument, negative one is counted from the end if from_end is set
+static int string_pos_arg(val_t *v, int len, int def, int from_end)
+{
+    int i;
+
+    if (!val_is_number(v)) {
+        return def;
+    }
+
+    i = val_2_integer(v);
+    if (i < 0) {
+        i = from_end ? i + len : 0;
+        return i < 0 ? 0 : i;
+    }
+    return i > len ? len : i;
+}
+
+static inline int string_is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+val_t string_native_intern(env_t *env, int ac, val_t *av)
+{
+    if (ac < 1 || !val_is_string(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    string_intern(env, av);
+
+    return *av;
+}
+
+val_t string_slice(env_t *env, int ac, val_t *av)
+{
+    int len, bgn, end;
+
+    if (ac < 1 || !string_view_of(env, av, &len)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    bgn = ac > 1 ? string_pos_arg(av + 1, len, 0, 1) : 0;
+    end = ac > 2 ? string_pos_arg(av + 2, len, len, 1) : len;
+
+    return string_part(env, av, bgn, end > bgn ? end - bgn : 0);
+}
+
+val_t string_substring(env_t *env, int ac, val_t *av)
+{
+    int len, bgn, end;
+
+    if (ac < 1 || !string_view_of(env, av, &len)) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    bgn = ac > 1 ? string_pos_arg(av + 1, len, 0, 0) : 0;
+    end = ac > 2 ? string_pos_arg(av + 2, len, len, 0) : len;
+
+    if (bgn > end) {
+        int tmp = bgn;
+        bgn = end;
+        end = tmp;
+    }
+
+    return string_part(env, av, bgn, end - bgn);
+}
+
+val_t string_trim(env_t *env, int ac, val_t *av)
+{
+    const char *s;
+    int bgn, end;
+
+    if (ac < 1 || !(s = string_view_of(env, av, &end))) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    for (bgn = 0; bgn < end && string_is_space(s[bgn]); bgn++)
+        ;
+    while (end > bgn && string_is_space(s[end - 1])) {
+        end--;
+    }
+
+    return string_part(env, av, bgn, end - bgn);
+}
+
+val_t string_starts_with(env_t *env, int ac, val_t *av)
+{
+    const char *s, *f;
+    int len, flen, pos;
+
+    if (ac < 1 || !(s = string_view_of(env, av, &len))) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    if (ac < 2 || !(f = string_view_of(env, av + 1, &flen))) {
+        return val_mk_boolean(0);
+    }
+
+    pos = ac > 2 ? string_pos_arg(av + 2, len, 0, 0) : 0;
+
+    return val_mk_boolean(pos + flen <= len && !memcmp(s + pos, f, flen));
+}
+
+val_t string_char_code_at(env_t *env, int ac, val_t *av)
+{
+    const char *s;
+    int len, i;
+
+    if (ac < 1 || !(s = string_view_of(env, av, &len))) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    i = ac > 1 && val_is_number(av + 1) ? val_2_integer(av + 1) : 0;
+    if (i < 0 || i >= len) {
+        return val_mk_nan();
+    }
+
+    return val_mk_number((uint8_t) s[i]);
+}
+
+/*
+ * Parts are counted first, then the space of them is reserved,
+ * so no GC happen while they are created.
+ */
+val_t string_split(env_t *env, int ac, val_t *av)
+{
+    const char *s, *sep;
+    int len, sep_len, need, n, i, bgn;
+    array_t *array;
+
+    if (ac < 1 || !(s = string_view_of(env, av, &len))) {
+        env_set_error(env, ERR_InvalidInput);
+        return val_mk_undefined();
+    }
+
+    if (ac < 2 || !(sep = string_view_of(env, av + 1, &sep_len))) {
+        intptr_t a = array_create(env, 1, av);
+
+        return a ? val_mk_array((void *)a) : val_mk_undefined();
+    }
+
+    n = 0;
+    need = 0;
+    if (sep_len == 0) {
+        n = len;
+    } else {
+        for (bgn = 0; 0 <= (i = bytes_find(s + bgn, len - bgn, sep, sep_len)); bgn += i + sep_len) {
+            need += string_part_space(i);
+            n++;
+        }
+        need += string_part_space(len - bgn);
+        n++;
+    }
+    need += array_mem_space_of(n < DEF_ELEM_SIZE ? DEF_ELEM_SIZE : n);
+
+    if (!env_heap_reserve(env, need)) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return val_mk_undefined();
+    }
+
+    array = _array_create(env, n);
+    if (!array) {
+        return val_mk_undefined();
+    }
+
+    // defence GC
+    s = string_view_of(env, av, &len);
+    sep = string_view_of(env, av + 1, &sep_len);
+
+    if (sep_len == 0) {
+        for (i = 0; i < n; i++) {
+            array->elems[i] = string_part(env, av, i, 1);
+        }
+    } else {
+        int k = 0;
+
+        for (bgn = 0; 0 <= (i = bytes_find(s + bgn, len - bgn, sep, sep_len)); bgn += i + sep_len) {
+            array->elems[k++] = string_part(env, av, bgn, i);
+        }
+        array->elems[k] = string_part(env, av, bgn, len - bgn);
+    }
+
+    return val_mk_array(array);
+}
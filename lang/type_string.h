@@ -33,10 +33,19 @@ SOFTWARE.
 
 #define MAGIC_STRING    (MAGIC_BASE + 3)
 
+// Concatenation shorter than this is copied directly, longer one makes a rope
+#define STRING_ROPE_THRESHOLD   32
+#define STRING_LEN_MAX          (0xFFFF - 1)
+// Part shorter than this is copied, longer one makes a slice of the parent
+#define STRING_SLICE_THRESHOLD  16
+
 typedef struct string_t {
     uint8_t magic;
     uint8_t age;
-    uint16_t size;
+    uint16_t size;                      // memory size of str, with the tail '\0'
+    uint16_t len;
+    uint16_t interned;                  // in the intern table of env
+    uint32_t hash;                      // 0: not computed yet
     char    str[0];
 } string_t;
 
@@ -50,30 +59,111 @@ static inline intptr_t string_mem_ptr(intptr_t s) {
     return s + sizeof(string_t);
 }
 
+static inline int string_mem_space_rope(void) {
+    return SIZE_ALIGN(sizeof(val_rope_t));
+}
+
+static inline int string_mem_space_slice(void) {
+    return SIZE_ALIGN(sizeof(val_slice_t));
+}
+
+static inline int string_is_rope(val_t *v) {
+    return val_is_heap_string(v) && ((val_rope_t *) val_2_intptr(v))->magic == MAGIC_STRING_ROPE;
+}
+
+static inline int string_is_slice(val_t *v) {
+    return val_is_heap_string(v) && ((val_slice_t *) val_2_intptr(v))->magic == MAGIC_STRING_SLICE;
+}
+
+/*
+ * Length of string, O(1) except foreign string.
+ * See string_length_of for string constant.
+ */
 static inline int string_len(val_t *v) {
     if (val_is_inline_string(v)) {
-        return 1;
+        return strlen(val_2_cstring(v));
     } else
     if (val_is_foreign_string(v)) {
         return strlen((void*)val_2_intptr(v));
     } else
     if (val_is_heap_string(v)) {
         string_t *s = (string_t *) val_2_intptr(v);
-        return strlen(s->str);
+        if (s->magic == MAGIC_STRING_ROPE) {
+            return ((val_rope_t *)s)->len;
+        } else
+        if (s->magic == MAGIC_STRING_SLICE) {
+            return ((val_slice_t *)s)->len;
+        }
+        return s->len;
     } else {
         return -1;
     }
 }
 
+static inline int string_is_true(val_t *v) {
+    const char *s = val_2_cstring(v);
+
+    // rope and slice are never empty
+    return s ? *s : 1;
+}
+
+/*
+ * Bytes of string, not terminated with '\0' for slice.
+ * Return NULL if v is not a string or a rope not flattened.
+ */
+static inline const char *string_view(val_t *v, int *len) {
+    if (string_is_slice(v)) {
+        val_slice_t *slice = (val_slice_t *) val_2_intptr(v);
+        const char *p = (const char *) val_2_intptr(&slice->parent);
+
+        if (val_is_heap_string(&slice->parent)) {
+            p += VAL_STRING_HEAD;
+        }
+        *len = slice->len;
+        return p + slice->off;
+    } else {
+        const char *p = val_2_cstring(v);
+
+        *len = p ? string_len(v) : 0;
+        return p;
+    }
+}
+
+const char *string_heap_flatten(env_t *env, val_t *v);
+
+/*
+ * Get the terminated bytes of string, rope or slice will be flattened (may cause GC).
+ * v should be a GC root (stack, variable...), it is updated to the flat string.
+ */
+static inline const char *string_flatten(env_t *env, val_t *v) {
+    const char *s = val_2_cstring(v);
+
+    return s || !val_is_heap_string(v) ? s : string_heap_flatten(env, v);
+}
+
+int string_length_of(env_t *env, val_t *v);
+uint32_t string_hash_of(env_t *env, val_t *v);
+
 val_t string_create_heap_val(env_t *env, int size);
 
+void string_intern(env_t *env, val_t *v);
+
 int string_compare(val_t *a, val_t *b);
+int string_is_equal(val_t *a, val_t *b);
 
 void string_add(env_t *env, val_t *a, val_t *b, val_t *res);
+void string_concat(env_t *env, int n, val_t *av, val_t *res);
 void string_at(env_t *env, val_t *a, val_t *b, val_t *res);
-void string_elem_get(val_t *self, int i, val_t *elem);
+void string_elem_get(void *env, val_t *self, int i, val_t *elem);
 val_t string_length(env_t *env, int ac, val_t *av);
 val_t string_index_of(env_t *env, int ac, val_t *av);
+val_t string_native_intern(env_t *env, int ac, val_t *av);
+val_t string_slice(env_t *env, int ac, val_t *av);
+val_t string_substring(env_t *env, int ac, val_t *av);
+val_t string_split(env_t *env, int ac, val_t *av);
+val_t string_trim(env_t *env, int ac, val_t *av);
+val_t string_starts_with(env_t *env, int ac, val_t *av);
+val_t string_char_code_at(env_t *env, int ac, val_t *av);
 
 #endif /* __LANG_STRING_INC__ */
 
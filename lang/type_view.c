@@ -0,0 +1,539 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "err.h"
+#include "type_array.h"
+#include "type_buffer.h"
+#include "type_view.h"
+
+/*
+ * Expand the loop for each kind of element, with the C type as parameter.
+ * The loops are kept simple, to be vectorized by compiler.
+ */
+#define VIEW_DISPATCH(kind, INT, FLOAT)         \
+    switch (kind) {                             \
+    case VIEW_INT8:     INT(int8_t);    break;  \
+    case VIEW_UINT8:    INT(uint8_t);   break;  \
+    case VIEW_INT16:    INT(int16_t);   break;  \
+    case VIEW_UINT16:   INT(uint16_t);  break;  \
+    case VIEW_INT32:    INT(int32_t);   break;  \
+    case VIEW_UINT32:   INT(uint32_t);  break;  \
+    case VIEW_FLOAT32:  FLOAT(float);   break;  \
+    default:            FLOAT(double);  break;  \
+    }
+
+static inline type_view_t *view_of(val_t *v) {
+    return (type_view_t *) val_2_intptr(v);
+}
+
+// Integer part of d, NaN and the out of range ones are 0. Cast to element type wraps it.
+static inline int64_t view_integer(double d) {
+    return (d > -9.2e18 && d < 9.2e18) ? (int64_t) d : 0;
+}
+
+static inline double view_number(val_t *v) {
+    return val_is_number(v) ? val_2_double(v) : 0;
+}
+
+static double view_get(type_view_t *view, int i)
+{
+    void *addr = view_addr(view);
+
+#define GET(T)          return ((T *) addr)[i]
+    VIEW_DISPATCH(view->kind, GET, GET)
+#undef GET
+
+    return 0;
+}
+
+static void view_put(type_view_t *view, int i, double d)
+{
+    void *addr = view_addr(view);
+
+#define PUT_INT(T)      ((T *) addr)[i] = (T) view_integer(d)
+#define PUT_FLOAT(T)    ((T *) addr)[i] = (T) d
+    VIEW_DISPATCH(view->kind, PUT_INT, PUT_FLOAT)
+#undef PUT_INT
+#undef PUT_FLOAT
+}
+
+static inline void view_init(type_view_t *view, int kind, int offset, int length)
+{
+    view->magic = MAGIC_VIEW;
+    view->age = 0;
+    view->kind = kind;
+    view->reserved = 0;
+    view->offset = offset;
+    view->length = length;
+    view->reserved2 = 0;
+}
+
+/*
+ * View(buffer[, byteOffset[, length]]) shares the bytes of buffer,
+ * View(length) and View(array) create a zero filled buffer.
+ */
+static val_t view_create(env_t *env, int kind, int ac, val_t *av)
+{
+    int size = view_elem_size(kind);
+    type_buffer_t *buf;
+    type_view_t *view;
+    int length = 0, i;
+
+    if (ac > 0 && val_is_buffer(av)) {
+        int bytes = _val_buffer_size(av);
+        int offset = 0;
+
+        if (ac > 1 && val_is_number(av + 1)) {
+            offset = val_2_integer(av + 1);
+        }
+        // bytes of slice may be not aligned to element
+        if (offset < 0 || offset > bytes || ((intptr_t)_val_buffer_addr(av) + offset) % size) {
+            env_set_error(env, ERR_InvalidInput);
+            return VAL_UNDEFINED;
+        }
+
+        length = (bytes - offset) / size;
+        if (ac > 2 && val_is_number(av + 2)) {
+            int n = val_2_integer(av + 2);
+
+            if (n < 0 || n > length) {
+                env_set_error(env, ERR_InvalidInput);
+                return VAL_UNDEFINED;
+            }
+            length = n;
+        }
+
+        view = env_heap_alloc(env, view_mem_space());
+        if (!view) {
+            env_set_error(env, ERR_NotEnoughMemory);
+            return VAL_UNDEFINED;
+        }
+
+        // defence GC
+        view_init(view, kind, offset, length);
+        view->buffer = *av;
+
+        return val_mk_view(view);
+    }
+
+    if (ac > 0) {
+        if (val_is_array(av)) {
+            length = array_len((array_t *) val_2_intptr(av));
+        } else
+        if (val_is_number(av)) {
+            length = val_2_integer(av);
+        }
+    }
+    if (length < 0 || length > BUFFER_SIZE_MAX / size) {
+        env_set_error(env, ERR_ResourceOutLimit);
+        return VAL_UNDEFINED;
+    }
+
+    if (!env_heap_reserve(env, view_mem_space() + buffer_mem_space_of(length * size))) {
+        env_set_error(env, ERR_NotEnoughMemory);
+        return VAL_UNDEFINED;
+    }
+
+    buf = buffer_create(env, length * size);
+    memset(_buffer_addr(buf), 0, length * size);
+
+    view = env_heap_alloc(env, view_mem_space());
+    view_init(view, kind, 0, length);
+    val_set_buffer(&view->buffer, buf);
+
+    if (ac > 0 && val_is_array(av)) {
+        val_t *elems = array_values((array_t *) val_2_intptr(av));
+
+        for (i = 0; i < length; i++) {
+            view_put(view, i, view_number(elems + i));
+        }
+    }
+
+    return val_mk_view(view);
+}
+
+val_t view_native_create_int8(env_t *env, int ac, val_t *av)
+{
+    return view_create(env, VIEW_INT8, ac, av);
+}
+
+val_t view_native_create_uint8(env_t *env, int ac, val_t *av)
+{
+    return view_create(env, VIEW_UINT8, ac, av);
+}
+
+val_t view_native_create_int16(env_t *env, int ac, val_t *av)
+{
+    return view_create(env, VIEW_INT16, ac, av);
+}
+
+val_t view_native_create_uint16(env_t *env, int ac, val_t *av)
+{
+    return view_create(env, VIEW_UINT16, ac, av);
+}
+
+val_t view_native_create_int32(env_t *env, int ac, val_t *av)
+{
+    return view_create(env, VIEW_INT32, ac, av);
+}
+
+val_t view_native_create_uint32(env_t *env, int ac, val_t *av)
+{
+    return view_create(env, VIEW_UINT32, ac, av);
+}
+
+val_t view_native_create_float32(env_t *env, int ac, val_t *av)
+{
+    return view_create(env, VIEW_FLOAT32, ac, av);
+}
+
+val_t view_native_create_float64(env_t *env, int ac, val_t *av)
+{
+    return view_create(env, VIEW_FLOAT64, ac, av);
+}
+
+void view_elem_get(void *env, val_t *self, int index, val_t *elem)
+{
+    type_view_t *view = view_of(self);
+
+    (void) env;
+    if (index >= 0 && (uint32_t) index < view->length) {
+        val_set_number(elem, view_get(view, index));
+    } else {
+        val_set_undefined(elem);
+    }
+}
+
+int view_elem_set(void *env, val_t *self, int index, val_t *elem)
+{
+    type_view_t *view = view_of(self);
+
+    (void) env;
+    if (index >= 0 && (uint32_t) index < view->length) {
+        view_put(view, index, view_number(elem));
+        return 0;
+    } else {
+        return -1;
+    }
+}
+
+val_t view_native_length(env_t *env, int ac, val_t *av)
+{
+    if (ac < 1 || !val_is_view(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    return val_mk_number(view_of(av)->length);
+}
+
+val_t view_native_buffer(env_t *env, int ac, val_t *av)
+{
+    if (ac < 1 || !val_is_view(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    return view_of(av)->buffer;
+}
+
+// fill(value[, start[, end]])
+val_t view_native_fill(env_t *env, int ac, val_t *av)
+{
+    type_view_t *view;
+    void *addr;
+    double d;
+    int i, bgn = 0, end;
+
+    if (ac < 2 || !val_is_view(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+    view = view_of(av);
+    addr = view_addr(view);
+    d = view_number(av + 1);
+
+    end = view->length;
+    if (ac > 2 && val_is_number(av + 2)) {
+        bgn = val_2_integer(av + 2);
+        if (ac > 3 && val_is_number(av + 3)) {
+            end = val_2_integer(av + 3);
+        }
+    }
+    bgn = bgn < 0 ? 0 : bgn;
+    end = end > (int) view->length ? (int) view->length : end;
+
+#define FILL_INT(T)     { T *p = addr, x = (T) view_integer(d); for (i = bgn; i < end; i++) p[i] = x; }
+#define FILL_FLOAT(T)   { T *p = addr, x = (T) d; for (i = bgn; i < end; i++) p[i] = x; }
+    VIEW_DISPATCH(view->kind, FILL_INT, FILL_FLOAT)
+#undef FILL_INT
+#undef FILL_FLOAT
+
+    return *av;
+}
+
+// copy(view | array[, offset]), elements are converted if kinds are different
+val_t view_native_copy(env_t *env, int ac, val_t *av)
+{
+    type_view_t *view;
+    int i, n, off = 0;
+
+    if (ac < 2 || !val_is_view(av) || !(val_is_view(av + 1) || val_is_array(av + 1))) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+    view = view_of(av);
+
+    if (ac > 2 && val_is_number(av + 2)) {
+        off = val_2_integer(av + 2);
+    }
+    if (off < 0 || off > (int) view->length) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+
+    if (val_is_view(av + 1)) {
+        type_view_t *src = view_of(av + 1);
+
+        n = src->length < view->length - off ? (int) src->length : (int) view->length - off;
+        if (src->kind == view->kind) {
+            int size = view_elem_size(view->kind);
+
+            memmove((uint8_t *) view_addr(view) + off * size, view_addr(src), n * size);
+        } else {
+            for (i = 0; i < n; i++) {
+                view_put(view, off + i, view_get(src, i));
+            }
+        }
+    } else {
+        array_t *src = (array_t *) val_2_intptr(av + 1);
+        val_t *elems = array_values(src);
+
+        n = array_len(src) < (int) view->length - off ? array_len(src) : (int) view->length - off;
+        for (i = 0; i < n; i++) {
+            view_put(view, off + i, view_number(elems + i));
+        }
+    }
+
+    return *av;
+}
+
+static val_t view_arith(env_t *env, int ac, val_t *av, int mul)
+{
+    type_view_t *view;
+    void *addr;
+    int i, n;
+
+    if (ac < 2 || !val_is_view(av) || !(val_is_number(av + 1) || val_is_view(av + 1))) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+    view = view_of(av);
+    addr = view_addr(view);
+    n = view->length;
+
+    if (val_is_number(av + 1)) {
+        double k = val_2_double(av + 1);
+
+        if (mul) {
+#define MUL_INT(T)      { T *p = addr; for (i = 0; i < n; i++) p[i] = (T) view_integer(p[i] * k); }
+#define MUL_FLOAT(T)    { T *p = addr; for (i = 0; i < n; i++) p[i] = (T) (p[i] * k); }
+            VIEW_DISPATCH(view->kind, MUL_INT, MUL_FLOAT)
+#undef MUL_INT
+#undef MUL_FLOAT
+        } else {
+#define ADD_INT(T)      { T *p = addr; for (i = 0; i < n; i++) p[i] = (T) view_integer(p[i] + k); }
+#define ADD_FLOAT(T)    { T *p = addr; for (i = 0; i < n; i++) p[i] = (T) (p[i] + k); }
+            VIEW_DISPATCH(view->kind, ADD_INT, ADD_FLOAT)
+#undef ADD_INT
+#undef ADD_FLOAT
+        }
+    } else {
+        type_view_t *other = view_of(av + 1);
+
+        n = other->length < view->length ? (int) other->length : n;
+        if (other->kind == view->kind) {
+            void *src = view_addr(other);
+
+            // integer elements wrap around, as the unsigned arithmetic
+            if (mul) {
+#define MUL_INT(T)      { T *p = addr; const T *q = src; for (i = 0; i < n; i++) p[i] = (T) ((uint64_t) p[i] * (uint64_t) q[i]); }
+#define MUL_FLOAT(T)    { T *p = addr; const T *q = src; for (i = 0; i < n; i++) p[i] = p[i] * q[i]; }
+                VIEW_DISPATCH(view->kind, MUL_INT, MUL_FLOAT)
+#undef MUL_INT
+#undef MUL_FLOAT
+            } else {
+#define ADD_INT(T)      { T *p = addr; const T *q = src; for (i = 0; i < n; i++) p[i] = (T) ((uint64_t) p[i] + (uint64_t) q[i]); }
+#define ADD_FLOAT(T)    { T *p = addr; const T *q = src; for (i = 0; i < n; i++) p[i] = p[i] + q[i]; }
+                VIEW_DISPATCH(view->kind, ADD_INT, ADD_FLOAT)
+#undef ADD_INT
+#undef ADD_FLOAT
+            }
+        } else {
+            for (i = 0; i < n; i++) {
+                double a = view_get(view, i), b = view_get(other, i);
+
+                view_put(view, i, mul ? a * b : a + b);
+            }
+        }
+    }
+
+    return *av;
+}
+
+// add(number | view), elements are added in place
+val_t view_native_add(env_t *env, int ac, val_t *av)
+{
+    return view_arith(env, ac, av, 0);
+}
+
+// mul(number | view), elements are multiplied in place
+val_t view_native_mul(env_t *env, int ac, val_t *av)
+{
+    return view_arith(env, ac, av, 1);
+}
+
+// scale(k[, bias]), each element = element * k + bias
+val_t view_native_scale(env_t *env, int ac, val_t *av)
+{
+    type_view_t *view;
+    void *addr;
+    double k, b = 0;
+    int i, n;
+
+    if (ac < 2 || !val_is_view(av) || !val_is_number(av + 1)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+    view = view_of(av);
+    addr = view_addr(view);
+    n = view->length;
+    k = val_2_double(av + 1);
+    if (ac > 2 && val_is_number(av + 2)) {
+        b = val_2_double(av + 2);
+    }
+
+#define SCALE_INT(T)    { T *p = addr; for (i = 0; i < n; i++) p[i] = (T) view_integer(p[i] * k + b); }
+#define SCALE_FLOAT(T)  { T *p = addr; for (i = 0; i < n; i++) p[i] = (T) (p[i] * k + b); }
+    VIEW_DISPATCH(view->kind, SCALE_INT, SCALE_FLOAT)
+#undef SCALE_INT
+#undef SCALE_FLOAT
+
+    return *av;
+}
+
+val_t view_native_sum(env_t *env, int ac, val_t *av)
+{
+    type_view_t *view;
+    void *addr;
+    double s = 0;
+    int i, n;
+
+    if (ac < 1 || !val_is_view(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+    view = view_of(av);
+    addr = view_addr(view);
+    n = view->length;
+
+#define SUM(T)          { const T *p = addr; for (i = 0; i < n; i++) s += p[i]; }
+    VIEW_DISPATCH(view->kind, SUM, SUM)
+#undef SUM
+
+    return val_mk_number(s);
+}
+
+static val_t view_extreme(env_t *env, int ac, val_t *av, int max)
+{
+    type_view_t *view;
+    void *addr;
+    double m;
+    int i, n;
+
+    if (ac < 1 || !val_is_view(av)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+    view = view_of(av);
+    addr = view_addr(view);
+    n = view->length;
+    if (!n) {
+        return VAL_UNDEFINED;
+    }
+    m = view_get(view, 0);
+
+    if (max) {
+#define MAX_OF(T)       { const T *p = addr; T x = p[0]; for (i = 1; i < n; i++) x = p[i] > x ? p[i] : x; m = x; }
+        VIEW_DISPATCH(view->kind, MAX_OF, MAX_OF)
+#undef MAX_OF
+    } else {
+#define MIN_OF(T)       { const T *p = addr; T x = p[0]; for (i = 1; i < n; i++) x = p[i] < x ? p[i] : x; m = x; }
+        VIEW_DISPATCH(view->kind, MIN_OF, MIN_OF)
+#undef MIN_OF
+    }
+
+    return val_mk_number(m);
+}
+
+val_t view_native_min(env_t *env, int ac, val_t *av)
+{
+    return view_extreme(env, ac, av, 0);
+}
+
+val_t view_native_max(env_t *env, int ac, val_t *av)
+{
+    return view_extreme(env, ac, av, 1);
+}
+
+// dot(view), sum of products of the elements
+val_t view_native_dot(env_t *env, int ac, val_t *av)
+{
+    type_view_t *view, *other;
+    void *addr, *src;
+    double s = 0;
+    int i, n;
+
+    if (ac < 2 || !val_is_view(av) || !val_is_view(av + 1)) {
+        env_set_error(env, ERR_InvalidInput);
+        return VAL_UNDEFINED;
+    }
+    view = view_of(av);
+    other = view_of(av + 1);
+    addr = view_addr(view);
+    src = view_addr(other);
+    n = other->length < view->length ? other->length : view->length;
+
+    if (other->kind == view->kind) {
+#define DOT(T)          { const T *p = addr, *q = src; for (i = 0; i < n; i++) s += (double) p[i] * q[i]; }
+        VIEW_DISPATCH(view->kind, DOT, DOT)
+#undef DOT
+    } else {
+        for (i = 0; i < n; i++) {
+            s += view_get(view, i) * view_get(other, i);
+        }
+    }
+
+    return val_mk_number(s);
+}
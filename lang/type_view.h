@@ -0,0 +1,101 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __LANG_TYPE_VIEW_INC__
+#define __LANG_TYPE_VIEW_INC__
+
+#include "config.h"
+
+#include "val.h"
+#include "env.h"
+#include "type_buffer.h"
+
+#define MAGIC_VIEW          (MAGIC_BASE + 23)
+
+// Kinds of element
+#define VIEW_INT8           0
+#define VIEW_UINT8          1
+#define VIEW_INT16          2
+#define VIEW_UINT16         3
+#define VIEW_INT32          4
+#define VIEW_UINT32         5
+#define VIEW_FLOAT32        6
+#define VIEW_FLOAT64        7
+
+/*
+ * Typed elements over the bytes of a buffer, referenced by TAG_VIEW value.
+ * offset is aligned to the element size, so elements could be accessed directly.
+ */
+typedef struct type_view_t {
+    uint8_t  magic;
+    uint8_t  age;
+    uint8_t  kind;
+    uint8_t  reserved;
+    uint32_t offset;                    // in bytes
+    uint32_t length;                    // in elements
+    uint32_t reserved2;
+    val_t    buffer;
+} type_view_t;
+
+static inline int view_mem_space(void) {
+    return SIZE_ALIGN(sizeof(type_view_t));
+}
+
+static inline int view_elem_size(int kind) {
+    return kind < VIEW_FLOAT32 ? 1 << (kind >> 1) : (kind == VIEW_FLOAT32 ? 4 : 8);
+}
+
+static inline void *view_addr(type_view_t *view) {
+    return (uint8_t *) _val_buffer_addr(&view->buffer) + view->offset;
+}
+
+static inline int view_is_true(val_t *v) {
+    return ((type_view_t *) val_2_intptr(v))->length > 0;
+}
+
+void view_elem_get(void *env, val_t *self, int index, val_t *elem);
+int  view_elem_set(void *env, val_t *self, int index, val_t *elem);
+
+val_t view_native_create_int8(env_t *env, int ac, val_t *av);
+val_t view_native_create_uint8(env_t *env, int ac, val_t *av);
+val_t view_native_create_int16(env_t *env, int ac, val_t *av);
+val_t view_native_create_uint16(env_t *env, int ac, val_t *av);
+val_t view_native_create_int32(env_t *env, int ac, val_t *av);
+val_t view_native_create_uint32(env_t *env, int ac, val_t *av);
+val_t view_native_create_float32(env_t *env, int ac, val_t *av);
+val_t view_native_create_float64(env_t *env, int ac, val_t *av);
+
+val_t view_native_length(env_t *env, int ac, val_t *av);
+val_t view_native_buffer(env_t *env, int ac, val_t *av);
+val_t view_native_fill(env_t *env, int ac, val_t *av);
+val_t view_native_copy(env_t *env, int ac, val_t *av);
+val_t view_native_add(env_t *env, int ac, val_t *av);
+val_t view_native_mul(env_t *env, int ac, val_t *av);
+val_t view_native_scale(env_t *env, int ac, val_t *av);
+val_t view_native_sum(env_t *env, int ac, val_t *av);
+val_t view_native_min(env_t *env, int ac, val_t *av);
+val_t view_native_max(env_t *env, int ac, val_t *av);
+val_t view_native_dot(env_t *env, int ac, val_t *av);
+
+#endif /* __LANG_TYPE_VIEW_INC__ */
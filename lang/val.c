@@ -26,10 +26,12 @@ SOFTWARE.
 #include "env.h"
 #include "type_number.h"
 #include "type_string.h"
+#include "type_builder.h"
 #include "type_array.h"
 #include "type_object.h"
 #include "type_function.h"
 #include "type_buffer.h"
+#include "type_view.h"
 
 const val_t _Infinity  = TAG_INFINITE;
 const val_t _Undefined = TAG_UNDEFINED;
@@ -307,8 +309,9 @@ static inline val_t *foreign_elem_ref(void *env, val_t *a, val_t *b) {
     }
 }
 
-static void def_elem_get(val_t *self, int index, val_t *elem)
+static void def_elem_get(void *env, val_t *self, int index, val_t *elem)
 {
+    (void) env;
     (void) self;
     (void) index;
     val_set_undefined(elem);
@@ -323,7 +326,6 @@ static val_t *def_elem_ref(val_t *self, int index)
 
 static val_t def_to_string(env_t *env, int ac, val_t *obj)
 {
-    (void) env;
     if (ac < 1) {
         return val_mk_foreign_string((intptr_t)"");
     }
@@ -332,7 +334,7 @@ static val_t def_to_string(env_t *env, int ac, val_t *obj)
         return *obj;
     } else
     if (val_is_number(obj)) {
-        return val_mk_foreign_string((intptr_t)"<number>");
+        return number_string_val(env, val_2_double(obj));
     } else
     if (val_is_undefined(obj)) {
         return val_mk_foreign_string((intptr_t)"<undefined>");
@@ -374,8 +376,10 @@ typedef struct prop_desc_t {
 } prop_desc_t;
 
 typedef struct type_desc_t {
-    void               (*elem_get)(val_t *, int, val_t*);
+    void               (*elem_get)(void *, val_t *, int, val_t*);
     val_t             *(*elem_ref)(val_t *, int index);
+    // for the elements not kept as val_t, optional
+    int                (*elem_set)(void *, val_t *, int, val_t*);
     int                prop_num;
     const prop_desc_t *prop_descs;
 } type_desc_t;
@@ -383,7 +387,7 @@ typedef struct type_desc_t {
 static const prop_desc_t number_prop_descs [] = {
     {
         .name = "toString",
-        .entry = def_to_string
+        .entry = number_to_string
     }
 };
 static const prop_desc_t string_prop_descs [] = {
@@ -393,6 +397,27 @@ static const prop_desc_t string_prop_descs [] = {
     }, {
         .name = "indexOf",
         .entry = string_index_of
+    }, {
+        .name = "slice",
+        .entry = string_slice
+    }, {
+        .name = "substring",
+        .entry = string_substring
+    }, {
+        .name = "split",
+        .entry = string_split
+    }, {
+        .name = "trim",
+        .entry = string_trim
+    }, {
+        .name = "startsWith",
+        .entry = string_starts_with
+    }, {
+        .name = "charCodeAt",
+        .entry = string_char_code_at
+    }, {
+        .name = "intern",
+        .entry = string_native_intern
     }
 };
 static const prop_desc_t boolean_prop_descs [] = {
@@ -441,12 +466,69 @@ static const prop_desc_t array_prop_descs [] = {
     }, {
         .name = "foreach",
         .entry = array_foreach
+    }, {
+        .name = "sort",
+        .entry = array_sort
+    }, {
+        .name = "reverse",
+        .entry = array_reverse
+    }, {
+        .name = "indexOf",
+        .entry = array_index_of
+    }, {
+        .name = "slice",
+        .entry = array_slice
+    }, {
+        .name = "concat",
+        .entry = array_concat
+    }, {
+        .name = "join",
+        .entry = array_join
+    }, {
+        .name = "map",
+        .entry = array_map
+    }, {
+        .name = "filter",
+        .entry = array_filter
+    }, {
+        .name = "reduce",
+        .entry = array_reduce
     }
 };
-static const prop_desc_t err_prop_descs [] = {
+static const prop_desc_t view_prop_descs [] = {
     {
-        .name = "toString",
-        .entry = def_to_string
+        .name = "length",
+        .entry = view_native_length
+    }, {
+        .name = "buffer",
+        .entry = view_native_buffer
+    }, {
+        .name = "fill",
+        .entry = view_native_fill
+    }, {
+        .name = "copy",
+        .entry = view_native_copy
+    }, {
+        .name = "add",
+        .entry = view_native_add
+    }, {
+        .name = "mul",
+        .entry = view_native_mul
+    }, {
+        .name = "scale",
+        .entry = view_native_scale
+    }, {
+        .name = "sum",
+        .entry = view_native_sum
+    }, {
+        .name = "min",
+        .entry = view_native_min
+    }, {
+        .name = "max",
+        .entry = view_native_max
+    }, {
+        .name = "dot",
+        .entry = view_native_dot
     }
 };
 static const prop_desc_t buf_prop_descs [] = {
@@ -462,6 +544,150 @@ static const prop_desc_t buf_prop_descs [] = {
         .name = "slice",
         .entry = buffer_native_slice
     },
+    {
+        .name = "copy",
+        .entry = buffer_native_copy
+    },
+    {
+        .name = "readInt8",
+        .entry = buffer_native_read_int8
+    },
+    {
+        .name = "readUInt8",
+        .entry = buffer_native_read_uint8
+    },
+    {
+        .name = "readInt16LE",
+        .entry = buffer_native_read_int16_le
+    },
+    {
+        .name = "readInt16BE",
+        .entry = buffer_native_read_int16_be
+    },
+    {
+        .name = "readUInt16LE",
+        .entry = buffer_native_read_uint16_le
+    },
+    {
+        .name = "readUInt16BE",
+        .entry = buffer_native_read_uint16_be
+    },
+    {
+        .name = "readInt32LE",
+        .entry = buffer_native_read_int32_le
+    },
+    {
+        .name = "readInt32BE",
+        .entry = buffer_native_read_int32_be
+    },
+    {
+        .name = "readUInt32LE",
+        .entry = buffer_native_read_uint32_le
+    },
+    {
+        .name = "readUInt32BE",
+        .entry = buffer_native_read_uint32_be
+    },
+    {
+        .name = "readFloat32LE",
+        .entry = buffer_native_read_float32_le
+    },
+    {
+        .name = "readFloat32BE",
+        .entry = buffer_native_read_float32_be
+    },
+    {
+        .name = "readFloat64LE",
+        .entry = buffer_native_read_float64_le
+    },
+    {
+        .name = "readFloat64BE",
+        .entry = buffer_native_read_float64_be
+    },
+    {
+        .name = "writeInt8",
+        .entry = buffer_native_write_int8
+    },
+    {
+        .name = "writeUInt8",
+        .entry = buffer_native_write_uint8
+    },
+    {
+        .name = "writeInt16LE",
+        .entry = buffer_native_write_int16_le
+    },
+    {
+        .name = "writeInt16BE",
+        .entry = buffer_native_write_int16_be
+    },
+    {
+        .name = "writeUInt16LE",
+        .entry = buffer_native_write_uint16_le
+    },
+    {
+        .name = "writeUInt16BE",
+        .entry = buffer_native_write_uint16_be
+    },
+    {
+        .name = "writeInt32LE",
+        .entry = buffer_native_write_int32_le
+    },
+    {
+        .name = "writeInt32BE",
+        .entry = buffer_native_write_int32_be
+    },
+    {
+        .name = "writeUInt32LE",
+        .entry = buffer_native_write_uint32_le
+    },
+    {
+        .name = "writeUInt32BE",
+        .entry = buffer_native_write_uint32_be
+    },
+    {
+        .name = "writeFloat32LE",
+        .entry = buffer_native_write_float32_le
+    },
+    {
+        .name = "writeFloat32BE",
+        .entry = buffer_native_write_float32_be
+    },
+    {
+        .name = "writeFloat64LE",
+        .entry = buffer_native_write_float64_le
+    },
+    {
+        .name = "writeFloat64BE",
+        .entry = buffer_native_write_float64_be
+    },
+    {
+        .name = "unpack",
+        .entry = buffer_native_unpack
+    },
+    {
+        .name = "pack",
+        .entry = buffer_native_pack
+    },
+    {
+        .name = "crc32",
+        .entry = buffer_native_crc32
+    },
+    {
+        .name = "crc32c",
+        .entry = buffer_native_crc32c
+    },
+    {
+        .name = "adler32",
+        .entry = buffer_native_adler32
+    },
+    {
+        .name = "fnv1a",
+        .entry = buffer_native_fnv1a
+    },
+    {
+        .name = "xxhash64",
+        .entry = buffer_native_xxhash64
+    },
     {
         .name = "toString",
         .entry = buffer_native_to_string
@@ -471,10 +697,22 @@ static const prop_desc_t buf_prop_descs [] = {
         .entry = def_length
     },
 };
-static const prop_desc_t date_prop_descs [] = {
+static const prop_desc_t builder_prop_descs [] = {
     {
+        .name = "append",
+        .entry = builder_native_append
+    }, {
+        .name = "appendChar",
+        .entry = builder_native_append_char
+    }, {
+        .name = "clear",
+        .entry = builder_native_clear
+    }, {
+        .name = "length",
+        .entry = builder_native_length
+    }, {
         .name = "toString",
-        .entry = def_to_string
+        .entry = builder_native_to_string
     }
 };
 
@@ -520,11 +758,12 @@ static const type_desc_t type_desc_nan = {
     .prop_num = sizeof(nan_prop_descs) / sizeof(prop_desc_t),
     .prop_descs = nan_prop_descs,
 };
-static const type_desc_t type_desc_err = {
-    .elem_get = def_elem_get,
+static const type_desc_t type_desc_view = {
+    .elem_get = view_elem_get,
     .elem_ref = def_elem_ref,
-    .prop_num = sizeof(err_prop_descs) / sizeof(prop_desc_t),
-    .prop_descs = err_prop_descs,
+    .elem_set = view_elem_set,
+    .prop_num = sizeof(view_prop_descs) / sizeof(prop_desc_t),
+    .prop_descs = view_prop_descs,
 };
 static const type_desc_t type_desc_buf = {
     .elem_get = buffer_elem_get,
@@ -532,11 +771,11 @@ static const type_desc_t type_desc_buf = {
     .prop_num = sizeof(buf_prop_descs) / sizeof(prop_desc_t),
     .prop_descs = buf_prop_descs,
 };
-static const type_desc_t type_desc_date = {
+static const type_desc_t type_desc_builder = {
     .elem_get = def_elem_get,
     .elem_ref = def_elem_ref,
-    .prop_num = sizeof(date_prop_descs) / sizeof(prop_desc_t),
-    .prop_descs = date_prop_descs,
+    .prop_num = sizeof(builder_prop_descs) / sizeof(prop_desc_t),
+    .prop_descs = builder_prop_descs,
 };
 static const type_desc_t type_desc_obj = {
     .elem_get = def_elem_get,
@@ -561,8 +800,8 @@ static const type_desc_t *const type_descs[] = {
     [TYPE_NAN]    = &type_desc_nan,
     [TYPE_ARRAY]  = &type_desc_array,
     [TYPE_BUF]    = &type_desc_buf,
-    [TYPE_ERR]    = &type_desc_err,
-    [TYPE_DATE]   = &type_desc_date,
+    [TYPE_VIEW]   = &type_desc_view,
+    [TYPE_BUILDER] = &type_desc_builder,
     [TYPE_OBJ]    = &type_desc_obj,
     [TYPE_FOREIGN]  = &type_desc_foreign,
 };
@@ -594,9 +833,9 @@ static void type_prop_val(int type, val_t *key, val_t *prop)
     }
 }
 
-static inline void type_elem_val(int type, val_t *self, int index, val_t *elem)
+static inline void type_elem_val(void *env, int type, val_t *self, int index, val_t *elem)
 {
-    type_descs[type]->elem_get(self, index, elem);
+    type_descs[type]->elem_get(env, self, index, elem);
 }
 
 static inline val_t *type_elem_ref(int type, val_t *self, int index)
@@ -610,16 +849,16 @@ int val_is_true(val_t *v)
     case TYPE_NUM:      return val_2_double(v) != 0;
     case TYPE_STR_I:
     case TYPE_STR_H:
-    case TYPE_STR_F:    return *val_2_cstring(v);
+    case TYPE_STR_F:    return string_is_true(v);
     case TYPE_BOOL:     return val_2_intptr(v);
     case TYPE_FUNC:
     case TYPE_FUNC_C:   return 1;
     case TYPE_UND:
     case TYPE_NAN:      return 0;
     case TYPE_ARRAY:    return array_is_true(v);
+    case TYPE_VIEW:     return view_is_true(v);
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:     return 0;
+    case TYPE_BUILDER:  return 0;
     case TYPE_OBJ:      return object_is_true(v);
     case TYPE_FOREIGN:  return foreign_is_true(v);
     default: return 0;
@@ -632,7 +871,7 @@ int val_is_equal(val_t *a, val_t *b)
         return !(val_is_nan(a) || val_is_undefined(a));
     } else {
         if (val_is_string(a)) {
-            return string_compare(a, b) == 0;
+            return string_is_equal(a, b);
         } else
         if (val_is_foreign(a)) {
             return foreign_is_equal(a, b);
@@ -656,8 +895,8 @@ int val_is_ge(val_t *op1, val_t *op2)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      return 0;
     case TYPE_FOREIGN:  return foreign_is_ge(op1, op2);
     default: return 0;
@@ -678,8 +917,8 @@ int val_is_gt(val_t *op1, val_t *op2)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      return 0;
     case TYPE_FOREIGN:  return foreign_is_gt(op1, op2);
     default: return 0;
@@ -700,8 +939,8 @@ int val_is_le(val_t *op1, val_t *op2)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      return 0;
     case TYPE_FOREIGN:  return foreign_is_le(op1, op2);
     default: return 0;
@@ -722,8 +961,8 @@ int val_is_lt(val_t *op1, val_t *op2)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      return 0;
     case TYPE_FOREIGN:  return foreign_is_lt(op1, op2);
     default: return 0;
@@ -745,8 +984,8 @@ void val_op_neg(void *env, val_t *oprand, val_t *result)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(result); break;
     case TYPE_FOREIGN:
     default:
@@ -769,8 +1008,8 @@ void val_op_not(void *env, val_t *oprand, val_t *result)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(result); break;
     case TYPE_FOREIGN:
     default:
@@ -793,8 +1032,8 @@ void val_op_inc(void *env, val_t *op1, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_inc(env, op1, res);
@@ -816,8 +1055,8 @@ void val_op_incp(void *env, val_t *op1, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_incp(env, op1, res);
@@ -839,8 +1078,8 @@ void val_op_dec(void *env, val_t *op1, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_dec(env, op1, res);
@@ -862,8 +1101,8 @@ void val_op_decp(void *env, val_t *op1, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_decp(env, op1, res);
@@ -885,8 +1124,8 @@ void val_op_mul(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_mul(env, op1, op2, res);
@@ -908,8 +1147,8 @@ void val_op_div(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_div(env, op1, op2, res);
@@ -931,8 +1170,8 @@ void val_op_mod(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_mod(env, op1, op2, res);
@@ -942,7 +1181,14 @@ void val_op_mod(void *env, val_t *op1, val_t *op2, val_t *res)
 void val_op_add(void *env, val_t *op1, val_t *op2, val_t *res)
 {
     switch(val_type(op1)) {
-    case TYPE_NUM:   number_add(op1, op2, res); break;
+    case TYPE_NUM:   if (val_is_string(op2)) {
+                         // op1 is a GC root, replaced by its text
+                         *op1 = number_string_val(env, val_2_double(op1));
+                         string_add(env, op1, op2, res);
+                     } else {
+                         number_add(op1, op2, res);
+                     }
+                     break;
     case TYPE_STR_I:
     case TYPE_STR_H:
     case TYPE_STR_F: string_add(env, op1, op2, res); break;
@@ -953,8 +1199,8 @@ void val_op_add(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_add(env, op1, op2, res);
@@ -976,8 +1222,8 @@ void val_op_sub(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_sub(env, op1, op2, res);
@@ -999,8 +1245,8 @@ void val_op_and(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_and(env, op1, op2, res);
@@ -1022,8 +1268,8 @@ void val_op_or(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_or(env, op1, op2, res);
@@ -1045,8 +1291,8 @@ void val_op_xor(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_xor(env, op1, op2, res);
@@ -1069,8 +1315,8 @@ void val_op_lshift(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_lshift(env, op1, op2, res);
@@ -1092,8 +1338,8 @@ void val_op_rshift(void *env, val_t *op1, val_t *op2, val_t *res)
     case TYPE_NAN:
     case TYPE_ARRAY:
     case TYPE_BUF:
-    case TYPE_ERR:
-    case TYPE_DATE:
+    case TYPE_VIEW:
+    case TYPE_BUILDER:
     case TYPE_OBJ:      val_set_nan(res); break;
     case TYPE_FOREIGN:
     default:            foreign_rshift(env, op1, op2, res);
@@ -1104,6 +1350,8 @@ void val_op_prop(void *env, val_t *self, val_t *key, val_t *prop)
 {
     int type = val_type(self);
 
+    string_flatten(env, key);
+
     if (type == TYPE_OBJ) {
         object_prop_val(env, self, key, prop);
     } else
@@ -1118,6 +1366,11 @@ void val_op_elem(void *env, val_t *self, val_t *key, val_t *prop)
 {
     int type = val_type(self);
 
+    string_flatten(env, key);
+    if (string_is_rope(self)) {
+        string_flatten(env, self);
+    }
+
     if (type == TYPE_OBJ) {
         object_prop_val(env, self, key, prop);
     } else
@@ -1125,7 +1378,7 @@ void val_op_elem(void *env, val_t *self, val_t *key, val_t *prop)
         foreign_elem(env, self, key, prop);
     } else {
         if (val_is_number(key)) {
-            type_elem_val(type, self, val_2_integer(key), prop);
+            type_elem_val(env, type, self, val_2_integer(key), prop);
         } else {
             type_prop_val(type, key, prop);
         }
@@ -1145,6 +1398,8 @@ val_t *val_prop_ref(void *env, val_t *self, val_t *key)
 {
     int type = val_type(self);
 
+    string_flatten(env, key);
+
     if (type == TYPE_OBJ) {
         return object_prop_ref(env, self, key);
     } else
@@ -1160,6 +1415,8 @@ val_t *val_elem_ref(void *env, val_t *self, val_t *id)
 {
     int type = val_type(self);
 
+    string_flatten(env, id);
+
     if (type == TYPE_OBJ) {
         return object_prop_ref(env, self, id);
     } else
@@ -1174,6 +1431,21 @@ val_t *val_elem_ref(void *env, val_t *self, val_t *id)
     }
 }
 
+/*
+ * Store elem by index, for the types without element reference.
+ * Return 0 if it is stored.
+ */
+int val_elem_set(void *env, val_t *self, val_t *id, val_t *elem)
+{
+    int type = val_type(self);
+
+    if (type_descs[type] && type_descs[type]->elem_set && val_is_number(id)) {
+        return type_descs[type]->elem_set(env, self, val_2_integer(id), elem);
+    } else {
+        return -1;
+    }
+}
+
 val_t val_create(void *env, const val_foreign_op_t *op, intptr_t data)
 {
     val_foreign_t *vf = env_heap_alloc(env, SIZE_ALIGN(sizeof(val_foreign_t)));
@@ -81,8 +81,8 @@ extern const val_t _Infinity;
 #define TYPE_NAN            8       // not a number
 #define TYPE_ARRAY          9       // array
 #define TYPE_BUF            10      // buffer
-#define TYPE_ERR            11      // error
-#define TYPE_DATE           12      // date
+#define TYPE_VIEW           11      // typed view of buffer
+#define TYPE_BUILDER        12      // string builder
 #define TYPE_OBJ            13      // object
 #define TYPE_FOREIGN        14      // object (foreign)
 #define TYPE_REF            15      // reference to variable
@@ -101,8 +101,8 @@ extern const val_t _Infinity;
 
 #define TAG_ARRAY           MAKE_TAG(1, TYPE_ARRAY)
 #define TAG_BUFFER          MAKE_TAG(1, TYPE_BUF)
-#define TAG_ERROR           MAKE_TAG(1, TYPE_ERR)
-#define TAG_DATE            MAKE_TAG(1, TYPE_DATE)
+#define TAG_VIEW            MAKE_TAG(1, TYPE_VIEW)
+#define TAG_BUILDER         MAKE_TAG(1, TYPE_BUILDER)
 #define TAG_OBJECT          MAKE_TAG(1, TYPE_OBJ)
 #define TAG_FOREIGN         MAKE_TAG(1, TYPE_FOREIGN)
 #define TAG_REFERENCE       MAKE_TAG(1, TYPE_REF)
@@ -119,6 +119,22 @@ extern const val_t _Infinity;
 #define VAL_FALSE           (TAG_BOOLEAN)
 
 #define MAGIC_FOREIGN       (MAGIC_BASE + 15)
+#define MAGIC_STRING_ROPE   (MAGIC_BASE + 17)
+#define MAGIC_STRING_SLICE  (MAGIC_BASE + 19)
+
+// Bytes before characters of heap string, sizeof(string_t)
+#define VAL_STRING_HEAD     (12)
+
+/*
+ * Inline string: up to 5 characters in the 48 bits payload, zero padded.
+ * The last payload byte is always 0, so the characters are terminated in place.
+ */
+#define VAL_INLINE_STRING_MAX   (5)
+#if SYS_BYTE_ORDER == LE
+# define VAL_INLINE_STRING_OFF  (0)
+#else
+# define VAL_INLINE_STRING_OFF  (2)
+#endif
 
 typedef struct val_foreign_op_t {
     int (*is_true)(intptr_t self);
@@ -158,6 +174,34 @@ typedef struct val_foreign_t {
     const val_foreign_op_t *op;
 } val_foreign_t;
 
+/*
+ * Concatenation of two strings, referenced by TAG_STRING_H value.
+ * Once flattened, left is the flat heap string and right is undefined.
+ */
+typedef struct val_rope_t {
+    uint8_t magic;
+    uint8_t age;
+    uint8_t reserved[2];
+    uint32_t len;
+    val_t left;
+    val_t right;
+} val_rope_t;
+
+/*
+ * Part of a string, referenced by TAG_STRING_H value.
+ * parent is a flat heap string or a foreign string, never a rope or slice.
+ * Only the tail slice (off + len == end) is terminated with '\0'.
+ */
+typedef struct val_slice_t {
+    uint8_t magic;
+    uint8_t age;
+    uint8_t reserved[2];
+    uint32_t len;
+    uint32_t off;
+    uint32_t end;                       // length of parent
+    val_t parent;
+} val_slice_t;
+
 static inline
 int val_type(val_t *v) {
     int type = (*v) >> 48;
@@ -247,6 +291,14 @@ static inline int val_is_buffer(val_t *v) {
     return (*v & TAG_MASK) == TAG_BUFFER;
 }
 
+static inline int val_is_builder(val_t *v) {
+    return (*v & TAG_MASK) == TAG_BUILDER;
+}
+
+static inline int val_is_view(val_t *v) {
+    return (*v & TAG_MASK) == TAG_VIEW;
+}
+
 static inline int val_is_object(val_t *v) {
     return (*v & TAG_MASK) == TAG_OBJECT;
 }
@@ -263,13 +315,35 @@ static inline const char *val_2_cstring(val_t *v) {
     uint64_t t = *v & TAG_MASK;
 
     if (t == TAG_STRING_I) {
-        return ((const char *)v) + 4;
+        return ((const char *)v) + VAL_INLINE_STRING_OFF;
     } else
     if (t == TAG_STRING_F) {
         return (const char *) val_2_intptr(v);
     } else
     if (t == TAG_STRING_H) {
-        return (const char *) (val_2_intptr(v) + 4);
+        val_rope_t *rope = (val_rope_t *) val_2_intptr(v);
+
+        if (rope->magic == MAGIC_STRING_ROPE) {
+            // not flattened yet, see string_flatten
+            if (!val_is_undefined(&rope->right)) {
+                return NULL;
+            }
+            return (const char *) (val_2_intptr(&rope->left) + VAL_STRING_HEAD);
+        } else
+        if (rope->magic == MAGIC_STRING_SLICE) {
+            val_slice_t *slice = (val_slice_t *) rope;
+            intptr_t p = val_2_intptr(&slice->parent);
+
+            // not terminated, see string_flatten
+            if (slice->off + slice->len != slice->end) {
+                return NULL;
+            }
+            if ((slice->parent & TAG_MASK) == TAG_STRING_H) {
+                p += VAL_STRING_HEAD;
+            }
+            return (const char *) p + slice->off;
+        }
+        return (const char *) (val_2_intptr(v) + VAL_STRING_HEAD);
     } else {
         return NULL;
     }
@@ -315,6 +389,14 @@ static inline val_t val_mk_buffer(void *ptr) {
     return TAG_BUFFER | (intptr_t) ptr;
 }
 
+static inline val_t val_mk_builder(void *ptr) {
+    return TAG_BUILDER | (intptr_t) ptr;
+}
+
+static inline val_t val_mk_view(void *ptr) {
+    return TAG_VIEW | (intptr_t) ptr;
+}
+
 static inline val_t val_mk_foreign(intptr_t f) {
     return TAG_FOREIGN | f;
 }
@@ -337,7 +419,13 @@ static inline void val_set_heap_string(val_t *p, intptr_t s) {
 
 static inline void val_set_inner_string(val_t *p, char c) {
     *((uint64_t *)p) = TAG_STRING_I;
-    *(((char *)p) + 4) = c;
+    *(((char *)p) + VAL_INLINE_STRING_OFF) = c;
+}
+
+// len should not greater than VAL_INLINE_STRING_MAX
+static inline void val_set_inline_string(val_t *p, const char *s, int len) {
+    *((uint64_t *)p) = TAG_STRING_I;
+    memcpy(((char *)p) + VAL_INLINE_STRING_OFF, s, len);
 }
 
 static inline void val_set_script(val_t *p, intptr_t s) {
@@ -364,6 +452,14 @@ static inline void val_set_buffer(val_t *p, void *b) {
     *((uint64_t *)p) = TAG_BUFFER | (intptr_t)b;
 }
 
+static inline void val_set_builder(val_t *p, void *b) {
+    *((uint64_t *)p) = TAG_BUILDER | (intptr_t)b;
+}
+
+static inline void val_set_view(val_t *p, void *v) {
+    *((uint64_t *)p) = TAG_VIEW | (intptr_t)v;
+}
+
 static inline void val_set_object(val_t *p, intptr_t d) {
     *((uint64_t *)p) = TAG_OBJECT | d;
 }
@@ -391,6 +487,7 @@ void val_op_prop(void *env, val_t *v, val_t *key, val_t *prop);
 void val_op_elem(void *env, val_t *v, val_t *key, val_t *elem);
 val_t *val_prop_ref(void *env, val_t *v, val_t *name);
 val_t *val_elem_ref(void *env, val_t *v, val_t *id);
+int val_elem_set(void *env, val_t *v, val_t *id, val_t *elem);
 
 void val_op_neg(void *env, val_t *oprand, val_t *res);
 void val_op_not(void *env, val_t *oprand, val_t *res);
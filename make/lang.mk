@@ -37,7 +37,11 @@ lang_SRCS = heap.c \
 			type_function.c \
 			type_array.c \
 			type_string.c \
+			bytes.c \
+			checksum.c \
 			type_buffer.c \
+			type_builder.c \
+			type_view.c \
 			type_object.c \
 
 lang_CPPFLAGS = -I.. -Wall -Wundef
@@ -44,7 +44,9 @@ test_SRCS = test.c \
 			test_lang_image.c \
 			test_lang_async.c \
 			test_lang_foreign.c \
-			test_lang_type_buffer.c
+			test_lang_type_buffer.c \
+			test_lang_type_builder.c \
+			test_lang_type_view.c
 test_CPPFLAGS = -I${BASE}
 test_CFLAGS   =
 test_LDFLAGS  = -L${BASE}/build/lang -L. -llang -lcunit
@@ -36,6 +36,8 @@ CU_pSuite test_lang_image_entry();
 CU_pSuite test_lang_async_entry();
 
 CU_pSuite test_lang_type_buffer();
+CU_pSuite test_lang_type_builder();
+CU_pSuite test_lang_type_view();
 CU_pSuite test_lang_type_foreign();
 
 int main(int argc, const char *argv[])
@@ -55,6 +57,8 @@ int main(int argc, const char *argv[])
     test_lang_async_entry();
 
     test_lang_type_buffer();
+    test_lang_type_builder();
+    test_lang_type_view();
     test_lang_type_foreign();
 
     CU_basic_set_mode(CU_BRM_VERBOSE);
@@ -30,6 +30,9 @@ SOFTWARE.
 #include "cunit/CUnit_Basic.h"
 
 #include "lang/interp.h"
+#include "lang/type_string.h"
+#include "lang/type_number.h"
+#include "lang/type_array.h"
 
 
 #define STACK_SIZE      128
@@ -725,6 +728,27 @@ static void test_exec_string(void)
     CU_ASSERT(0 < interp_execute_string(&env, "a[0] == 'h'", &res) && val_is_boolean(res) && val_is_true(res));
     CU_ASSERT(0 < interp_execute_string(&env, "a[0].length()", &res) && val_is_number(res) && 1 == val_2_integer(res));
 
+    // length of constant & heap string
+    CU_ASSERT(0 < interp_execute_string(&env, "var s = 'hello world, hello panda', i = 0, n = 0, o = {};", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (i < s.length()) { if (s[i] == 'l') n = n + 1; i = i + 1 }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "n", &res) && val_is_number(res) && 5 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s = s + '!'", &res) && val_is_string(res) && 25 == string_len(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.length()", &res) && val_is_number(res) && 25 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s[24] == '!' && !s[25]", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s == 'hello world, hello panda!'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s != 'hello world, hello panda?'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s != s + '?'", &res) && val_is_true(res));
+
+    // hash of heap string is used as key
+    CU_ASSERT(0 < interp_execute_string(&env, "o[s] = 1; o['hello world, hello panda!']", &res) && val_is_number(res) && 1 == val_2_integer(res));
+
+    // short string is kept in value
+    CU_ASSERT(0 < interp_execute_string(&env, "s = 'o' + 'k'", &res) && val_is_inline_string(res) && 2 == string_len(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s == 'ok' && s != 'on' && s < 'on'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s = s + 'ay' + '!'", &res) && val_is_inline_string(res) && !strcmp("okay!", val_2_cstring(res)));
+    CU_ASSERT(0 < interp_execute_string(&env, "s = s + '?'", &res) && val_is_heap_string(res) && !strcmp("okay!?", val_2_cstring(res)));
+    CU_ASSERT(0 < interp_execute_string(&env, "o[s[0] + s[1]] = 2; o.ok", &res) && val_is_number(res) && 2 == val_2_integer(res));
+
     env_deinit(&env);
 }
 
@@ -841,6 +865,192 @@ static void test_exec_array(void)
     env_deinit(&env);
 }
 
+static void test_exec_array_number(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = [1, 2.5, -3], b = [], c = [1, 2, 3], d = [0, 0], s = 'abc';", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a", &res) && val_is_array(res) && array_is_number_elems((array_t *)val_2_intptr(res)));
+    CU_ASSERT(0 < interp_execute_string(&env, "b", &res) && val_is_array(res) && array_is_number_elems((array_t *)val_2_intptr(res)));
+    CU_ASSERT(0 < interp_execute_string(&env, "[1, 'x']", &res) && val_is_array(res) && !array_is_number_elems((array_t *)val_2_intptr(res)));
+
+    // number stores keep the kind
+    CU_ASSERT(0 < interp_execute_string(&env, "a[0] = 5; a[1] += 1; a[2]++; b.push(1, 2); b.unshift(0); a", &res) &&
+              val_is_array(res) && array_is_number_elems((array_t *)val_2_intptr(res)));
+    CU_ASSERT(0 < interp_execute_string(&env, "b", &res) && val_is_array(res) && array_is_number_elems((array_t *)val_2_intptr(res)));
+
+    // first other store turns to any, and the values are kept by gc
+    CU_ASSERT(0 < interp_execute_string(&env, "a[1] = s + 'defgh'; b.push(s + 'ijklm'); c[0] += 'nopqr'; d.unshift([s + 'stuvw']);", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a", &res) && val_is_array(res) && !array_is_number_elems((array_t *)val_2_intptr(res)));
+    CU_ASSERT(0 < interp_execute_string(&env, "c", &res) && val_is_array(res) && !array_is_number_elems((array_t *)val_2_intptr(res)));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 < interp_execute_string(&env, "a[0] == 5 && a[1] == 'abcdefgh' && a[2] == -2", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b[3] == 'abcijklm' && c[0] == '1nopqr' && d[0][0] == 'abcstuvw'", &res) && val_is_true(res));
+
+    // kind is not back, after the other one removed
+    CU_ASSERT(0 < interp_execute_string(&env, "b.pop(); b", &res) && val_is_array(res) && !array_is_number_elems((array_t *)val_2_intptr(res)));
+
+    env_deinit(&env);
+}
+
+#define LARGE_HEAP_SIZE     (1024 * 1024 * 4)
+#define LARGE_ENV_BUF_SIZE  (sizeof(val_t) * STACK_SIZE + LARGE_HEAP_SIZE + EXE_MEM_SPACE + SYM_MEM_SPACE)
+
+static uint8_t large_env_buf[LARGE_ENV_BUF_SIZE];
+
+static void test_exec_array_grow(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    // storage grows more than once, and be moved by gc
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = [], b = [], i = 0, sum = 0;", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (i < 40) { a.push(i); b.unshift(i); i++ }", &res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 < interp_execute_string(&env, "a.length() == 40 && b.length() == 40", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a[0] == 0 && a[39] == 39 && b[0] == 39 && b[39] == 0", &res) && val_is_true(res));
+
+    // as queue, elements are moved to head instead of growing
+    CU_ASSERT(0 < interp_execute_string(&env, "i = 0; while (i < 1000) { a.push(a.shift()); i++ }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.length() == 40 && a[0] == 0 && a[39] == 39", &res) && val_is_true(res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 < interp_execute_string(&env, "a.foreach(def(v) sum += v); sum", &res) && val_is_number(res) && 780 == val_2_integer(res));
+
+    env_deinit(&env);
+
+    // out of 65535 elements
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, large_env_buf, LARGE_ENV_BUF_SIZE, NULL, LARGE_HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = [], i = 0;", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (i < 70000) { a.push(i); i++ }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.length()", &res) && val_is_number(res) && 70000 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a[65535] == 65535 && a[69999] == 69999", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.pop() + a.shift()", &res) && val_is_number(res) && 69999 == val_2_integer(res));
+
+    env_deinit(&env);
+}
+
+static void test_exec_array_native(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = [3, 1, 2], b = ['b', 'c', 'a'], c, s = 'abc';", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a.sort().join()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1,2,3"));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.sort().join('')", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "abc"));
+    CU_ASSERT(0 < interp_execute_string(&env, "[s, 2, true, 'a', 1].sort().join('-')", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1-2-a-abc-true"));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.sort(def(x, y) return y - x).join()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "3,2,1"));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.reverse()[0] == 1 && a[2] == 3", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a.indexOf(2) == 1 && a.indexOf(4) == -1 && a.indexOf(1, 1) == -1", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "[s + 'defghijklmnopqrstuvwxyz0123456789', 'x'].indexOf('x')", &res) && val_is_number(res) && 1 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.indexOf('c')", &res) && val_is_number(res) && 2 == val_2_integer(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "c = a.slice(1); c.length() == 2 && c[0] == 2", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.slice(-2, -1).join() == '2' && a.slice(2, 1).length() == 0", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "c = a.concat(b, 4); c.length() == 7 && c[3] == 'a' && c[6] == 4", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "[1.5, s, [], true].join(', ')", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1.5, abc, <array>, true"));
+    CU_ASSERT(0 < interp_execute_string(&env, "[].join()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), ""));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "c = a.map(def(v, i) return v * i); c.join()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "0,2,6"));
+    CU_ASSERT(0 < interp_execute_string(&env, "c", &res) && val_is_array(res) && array_is_number_elems((array_t *)val_2_intptr(res)));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.filter(def(v) return v != 2).join()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1,3"));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.reduce(def(acc, v) return acc + v)", &res) && val_is_number(res) && 6 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.reduce(def(acc, v, i) { return acc + v + i }, '')", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "a0b1c2"));
+    CU_ASSERT(0 < interp_execute_string(&env, "[].reduce(def(acc, v) return acc + v)", &res) && val_is_undefined(res));
+
+    // values made by callbacks are kept by gc
+    CU_ASSERT(0 < interp_execute_string(&env, "c = b.map(def(v) return s + v + 'defghijklmnopqrstuvwxyz0123456789');", &res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 < interp_execute_string(&env, "c[2] == 'abccdefghijklmnopqrstuvwxyz0123456789'", &res) && val_is_true(res));
+
+    CU_ASSERT(0 > interp_execute_string(&env, "a.map(1)", &res));
+
+    env_deinit(&env);
+
+    // introsort on the long array
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, large_env_buf, LARGE_ENV_BUF_SIZE, NULL, LARGE_HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = [], b, i = 0, x = 1, ok = 1;", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (i < 2000) { x = (x * 75 + 74) % 65537; a.push(x % 100); i++ }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b = a.slice(); a.sort(); b.sort(def(x, y) return x - y)", &res) && val_is_array(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "i = 1; while (i < 2000) { if (a[i - 1] > a[i] || a[i] != b[i]) ok = 0; i++ } ok", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.reverse(); a.sort(def(x, y) return y - x); a[0] == 99 && a[1999] == 0", &res) && val_is_true(res));
+
+    env_deinit(&env);
+}
+
+static void test_exec_callback(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = [1, 2, 3], o = {x: 1, y: 2}, fs = [], s = 'abc', t = 0;", &res));
+
+    // variables of reused scope are reset for each call
+    CU_ASSERT(0 < interp_execute_string(&env, "a.foreach(def(v) { var y; if (v == 1) y = 5; t = y }); t", &res) && val_is_undefined(res));
+
+    // scope captured by closure is not reused
+    CU_ASSERT(0 < interp_execute_string(&env, "a.foreach(def(v) { var y = v * 10; fs.push(def() return y) }); fs[0]() + fs[2]()", &res) &&
+              val_is_number(res) && 40 == val_2_integer(res));
+
+    // nested, and values made by callback are kept by gc
+    CU_ASSERT(0 < interp_execute_string(&env, "t = 0; a.foreach(def(v) { a.foreach(def(w) { t = t + v * w }) }); t", &res) && val_is_number(res) && 36 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t = 0; a.foreach(def(v) { var x = s + v + 'defghijklmnopqrstuvwxyz0123456789'; t = t + x.length() }); t", &res) &&
+              val_is_number(res) && 111 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t = ''; o.foreach(def(v, k) { t = t + k + v }); t", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "x1y2"));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a.map(def(v) return v + t.length()).join()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "5,6,7"));
+
+    // error in callback stops the iteration
+    CU_ASSERT(0 > interp_execute_string(&env, "a.foreach(def(v) { t = v; t() })", &res));
+    CU_ASSERT(env.error == ERR_InvalidCallor);
+
+    env_deinit(&env);
+}
+
+static void test_exec_for(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = [1, 2, 3], o = {x: 1, y: 2}, t = 0;", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "for i in a { t = t + i }; t", &res) && val_is_number(res) && 3 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t = 0; for (var v of a) { t = t + v }; t", &res) && val_is_number(res) && 6 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t = ''; for k in o { t = t + k + o[k] }; t", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "x1y2"));
+    CU_ASSERT(0 < interp_execute_string(&env, "t = 0; for v of o { t = t + v }; t", &res) && val_is_number(res) && 3 == val_2_integer(res));
+
+    // nothing to walk
+    CU_ASSERT(0 < interp_execute_string(&env, "t = 0; for v of [] { t = 1 }; for v of 1 { t = 2 }; t", &res) && val_is_number(res) && 0 == val_2_integer(res));
+
+    // break, continue and nested loops
+    CU_ASSERT(0 < interp_execute_string(&env, "t = 0; for v of a { if (v == 2) continue; if (v == 3) break; t = t + v }; t", &res) &&
+              val_is_number(res) && 1 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t = 0; for v of a { for w of a { if (w > v) break; t = t + w } }; t", &res) &&
+              val_is_number(res) && 10 == val_2_integer(res));
+
+    // loop variable is local to function, and return out of loop
+    CU_ASSERT(0 < interp_execute_string(&env, "def find(x) { for i in a { if (a[i] == x) return i }; return -1 }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "find(3) + find(4)", &res) && val_is_number(res) && 1 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "def sum(b) { var s = 0; for v of b { s = s + v }; return s }; sum(a) + sum([4, 5])", &res) &&
+              val_is_number(res) && 15 == val_2_integer(res));
+
+    env_deinit(&env);
+}
+
 static void test_exec_closure(void)
 {
     env_t env;
@@ -901,6 +1111,287 @@ static void test_exec_func_arg(void)
     env_deinit(&env);
 }
 
+static void test_exec_string_rope(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var s = '', t, n = 0, o = {};", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (n < 40) { s = s + 'abcdefgh'; n = n + 1 }", &res));
+    env_heap_gc(&env, 0);
+
+    // flattened by native call
+    CU_ASSERT(0 < interp_execute_string(&env, "s.length()", &res) && val_is_number(res) && 320 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s[317] == 'f'", &res) && val_is_true(res));
+
+    // flattened by compare
+    CU_ASSERT(0 < interp_execute_string(&env, "t = 'hello' + s + 'world'", &res) && val_is_string(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t == 'hello' + s + 'world'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t != s", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t > s", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t + t ? true : false", &res) && val_is_true(res));
+
+    // rope as key and element
+    CU_ASSERT(0 < interp_execute_string(&env, "o['abcdefghijklmnopqrstuvwxyz' + '0123456789'] = 1", &res) && val_is_number(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "o['abcdefghijklmnopqrstuvwxyz0123456789'] == 1", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "(t + t)[325] == 'w'", &res) && val_is_true(res));
+
+    // result given to host
+    CU_ASSERT(0 < interp_execute_string(&env, "n = 0; t = ''; while (n < 2) { t = t + s; n = n + 1 }", &res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 < interp_execute_string(&env, "t", &res) && val_is_string(res) && 640 == strlen(val_2_cstring(res)));
+    CU_ASSERT(0 < interp_execute_string(&env, "t.indexOf('ha')", &res) && val_is_number(res) && 7 == val_2_integer(res));
+
+    env_deinit(&env);
+}
+
+static void test_exec_string_slice(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var s = 'abcdefghijklmnopqrstuvwxyz' + '0123456789', t, a;", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "t = s.slice(2, 20)", &res) && val_is_string(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t.length() == 18 && t[0] == 'c' && t[17] == 't'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t == 'cdefghijklmnopqrst'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t.slice(1, 17) == 'defghijklmnopqrs'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.slice(-3) == '789'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.slice(-12, -4) == 'yz012345'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.slice(5, 2) == ''", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "s.substring(8, 2) == 'cdefgh'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.substring(-4, 3) == 'abc'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.substring(30) == '456789'", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "'  a b \\t\\n'.trim() == 'a b'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "'   '.trim() == ''", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.startsWith('abc') && !s.startsWith('abd')", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t.startsWith('def', 1)", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t.charCodeAt(0)", &res) && val_is_number(res) && 'c' == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "t.charCodeAt(18)", &res) && val_is_nan(res));
+    env_deinit(&env);
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 < interp_execute_string(&env, "var t = ('abcdefghijklmnopqrstuvwxyz' + '0123456789').slice(2, 20), a;", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a = 'GET /index.html HTTP/1.1,,x'.split(',')", &res) && val_is_array(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.length() == 3 && a[1] == '' && a[2] == 'x'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a = a[0].split(' ')", &res) && val_is_array(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a[0] == 'GET' && a[1] == '/index.html' && a[2] == 'HTTP/1.1'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a = 'abc'.split('')", &res) && val_is_array(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.length() == 3 && a[2] == 'c'", &res) && val_is_true(res));
+
+    // slice keeps the parent alive, and is moved by GC
+    CU_ASSERT(0 < interp_execute_string(&env, "a = t.slice(4)", &res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 < interp_execute_string(&env, "a + t == 'ghijklmnopqrstcdefghijklmnopqrst'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.indexOf('rs')", &res) && val_is_number(res) && 11 == val_2_integer(res));
+
+    env_deinit(&env);
+}
+
+static void test_exec_string_search(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var s = 'INFO boot;WARN temperature high;INFO ready;ERROR sensor lost;';", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "s.indexOf('ERROR')", &res) && val_is_number(res) && 43 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.indexOf('INFO', 1)", &res) && val_is_number(res) && 32 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.indexOf(';', 59)", &res) && val_is_number(res) && 60 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.indexOf('lost;')", &res) && val_is_number(res) && 56 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.indexOf('lost;;')", &res) && val_is_number(res) && -1 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.indexOf('hig')", &res) && val_is_number(res) && 27 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.indexOf('')", &res) && val_is_number(res) && 0 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.slice(11, 40).indexOf('WARN')", &res) && val_is_number(res) && -1 == val_2_integer(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "s.split(';').length()", &res) && val_is_number(res) && 5 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.split('INFO ')[2] == 'ready;ERROR sensor lost;'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s > 'INFO boot' && s < 'INFO boot;X'", &res) && val_is_true(res));
+
+    env_deinit(&env);
+}
+
+static void test_exec_string_intern(void)
+{
+    env_t env;
+    val_t *res, a;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = ('message' + '-type').intern(), b, o = {};", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b = ('messa' + 'ge-type').intern()", &res) && val_is_heap_string(res));
+    CU_ASSERT(1 == env.intern_tbl_hold);
+    a = *res;
+    CU_ASSERT(0 < interp_execute_string(&env, "a", &res) && *res == a);
+    CU_ASSERT(0 < interp_execute_string(&env, "a == b && a != 'message-typ'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "o[a] = 1; o['message-type'] == 1", &res) && val_is_true(res));
+
+    // moved by gc, still interned
+    env_heap_gc(&env, 0);
+    CU_ASSERT(1 == env.intern_tbl_hold);
+    CU_ASSERT(0 < interp_execute_string(&env, "a", &res) && *res != a);
+    a = *res;
+    CU_ASSERT(0 < interp_execute_string(&env, "('message-' + 'type').intern()", &res) && *res == a);
+    CU_ASSERT(0 < interp_execute_string(&env, "('message-type' + '-' + 'long').slice(0, 12).intern() == 'message-type'.slice(0, 12)", &res) && val_is_true(res));
+    CU_ASSERT(1 == env.intern_tbl_hold);
+
+    // unreachable ones are dropped
+    CU_ASSERT(0 < interp_execute_string(&env, "a = 0; b = 0", &res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 == env.intern_tbl_hold);
+
+    // table grows up beyond the initial size
+    CU_ASSERT(0 < interp_execute_string(&env, "var k = [], i = 10; while (i < 40) { k.push(('key-' + i).intern()); i = i + 1 }", &res));
+    CU_ASSERT(30 == env.intern_tbl_hold && env.intern_tbl_size > DEF_INTERN_TBL_SIZE);
+    CU_ASSERT(0 < interp_execute_string(&env, "k[29] == ('key-' + 39).intern() && k[0] == ('key-' + 10).intern()", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "k[20]", &res));
+    a = *res;
+    CU_ASSERT(0 < interp_execute_string(&env, "('key-' + '30').intern()", &res) && *res == a);
+    env_heap_gc(&env, 0);
+    CU_ASSERT(30 == env.intern_tbl_hold);
+    CU_ASSERT(0 < interp_execute_string(&env, "k[20]", &res) && *res != a);
+    a = *res;
+    CU_ASSERT(0 < interp_execute_string(&env, "('key-' + '30').intern()", &res) && *res == a);
+
+    // and shrinks as they are dropped
+    CU_ASSERT(0 < interp_execute_string(&env, "k = 0", &res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 == env.intern_tbl_hold && 0 == env.intern_tbl_size);
+
+    env_deinit(&env);
+}
+
+static void test_exec_number_to_string(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "(0).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "0"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(-120).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "-120"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(9007199254740991).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "9007199254740991"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(0.1).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "0.1"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(0.1 + 0.2).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "0.30000000000000004"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(-36.625).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "-36.625"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(1 / 3).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "0.3333333333333333"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(0.000001).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "0.000001"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(0.0000001).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1e-7"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(1e21).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1e+21"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(1e300 * 2).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "2e+300"));
+    CU_ASSERT(0 < interp_execute_string(&env, "(-2.5e-8).toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "-2.5e-8"));
+
+    // concatenate with string
+    CU_ASSERT(0 < interp_execute_string(&env, "var t = 21.5;", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "'t=' + t", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "t=21.5"));
+    CU_ASSERT(0 < interp_execute_string(&env, "t + 'C'", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "21.5C"));
+    CU_ASSERT(0 < interp_execute_string(&env, "t + 1 + 'C'", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "22.5C"));
+    CU_ASSERT(0 < interp_execute_string(&env, "t += '!'; t", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "21.5!"));
+
+    // the target of "+=" may be moved by GC while the text is allocated
+    CU_ASSERT(0 < interp_execute_string(&env, "var o, c, i = 0, j = 0, bad = 0, s = 'abcdefghijklmnopqrstuvwxyz';", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (i < 200) { o = {n: i + 0.5}; o.n += s; if (o.n != i + 0.5 + s) { bad = bad + 1 } i = i + 1 }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (j < 200) { c = [j + 0.5, 2, 3]; c[0] += s; if (c[0] != j + 0.5 + s) { bad = bad + 1 } j = j + 1 }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "bad", &res) && val_is_number(res) && 0 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "o.n", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "199.5abcdefghijklmnopqrstuvwxyz"));
+    CU_ASSERT(0 < interp_execute_string(&env, "def f(n) { var k = 0, x; while (k < 100) { x = n + k; x += s; k = k + 1 } return x }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "f(0.25)", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "99.25abcdefghijklmnopqrstuvwxyz"));
+
+    env_deinit(&env);
+}
+
+static void test_exec_number_parse(void)
+{
+    env_t env;
+    val_t *res;
+    native_t native_entry[] = {
+        {"parseInt", number_native_parse_int},
+        {"parseFloat", number_native_parse_float},
+        {"Number", number_native_create},
+    };
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 3));
+
+    // literal
+    CU_ASSERT(0 < interp_execute_string(&env, "0.1 + 0.2 == 0.30000000000000004", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "1e23", &res) && val_is_number(res) && 1e23 == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "0x1F", &res) && val_is_number(res) && 31 == val_2_integer(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "parseInt(' -42px')", &res) && val_is_number(res) && -42 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseInt('0xff')", &res) && val_is_number(res) && 255 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseInt('777', 8)", &res) && val_is_number(res) && 511 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseInt('3.9')", &res) && val_is_number(res) && 3 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseInt('px')", &res) && val_is_nan(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseInt('1', 40)", &res) && val_is_nan(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "parseFloat('  -36.625;')", &res) && val_is_number(res) && -36.625 == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseFloat('1.5e-3s')", &res) && val_is_number(res) && 1.5e-3 == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseFloat('.5')", &res) && val_is_number(res) && 0.5 == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseFloat('e5')", &res) && val_is_nan(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseFloat(1)", &res) && val_is_nan(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "Number(' 12.5 ')", &res) && val_is_number(res) && 12.5 == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "Number('')", &res) && val_is_number(res) && 0 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "Number(true)", &res) && val_is_number(res) && 1 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "Number('12px')", &res) && val_is_nan(res));
+
+    // fields of line, by slice of string
+    CU_ASSERT(0 < interp_execute_string(&env, "var f = '1700000000,21.75,-0.125'.split(','), sum = 0;", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "sum = parseFloat(f[1]) + Number(f[2]); sum", &res) && val_is_number(res) && 21.625 == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "parseInt(f[0])", &res) && val_is_number(res) && 1700000000 == val_2_double(res));
+
+    env_deinit(&env);
+}
+
+static void test_exec_string_concat(void)
+{
+    env_t env;
+    val_t *res;
+    int free;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var id = 'device-0001', v = 'value', s = '', n = 'ab';", &res));
+
+    // one allocation for the whole chain
+    free = env.heap->free;
+    CU_ASSERT(0 < interp_execute_string(&env, "s = 'id=' + id + ',v=' + v + ';'", &res) && val_is_string(res));
+    CU_ASSERT(env.heap->free - free == SIZE_ALIGN(sizeof(string_t) + 24));
+    CU_ASSERT(0 < interp_execute_string(&env, "s == 'id=device-0001,v=value;'", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "'a' + 'b' + 'c' + 'd'", &res) && val_is_inline_string(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "'x' + id + (v + '!') + 'y' == 'xdevice-0001value!y'", &res) && val_is_true(res));
+    // longer than LIMIT_CONCAT_SIZE
+    CU_ASSERT(0 < interp_execute_string(&env, "'<' + n + n + n + n + n + n + n + n + n + n + n + n + n + n + n + n + n + n + n", &res) &&
+              val_is_string(res) && !strcmp(val_2_cstring(res), "<ababababababababababababababababababab"));
+
+    // numbers are joined as their text, still one allocation
+    CU_ASSERT(0 < interp_execute_string(&env, "var i = 1024, r = -0.25;", &res));
+    free = env.heap->free;
+    CU_ASSERT(0 < interp_execute_string(&env, "s = 'id=' + i + ',v=' + r + ';'", &res) && val_is_string(res));
+    CU_ASSERT(env.heap->free - free == SIZE_ALIGN(sizeof(string_t) + 17));
+    CU_ASSERT(0 < interp_execute_string(&env, "s == 'id=1024,v=-0.25;'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "'a' + 1 + 'b'", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "a1b"));
+
+    // not all of operands are string or number, added one by one
+    CU_ASSERT(0 < interp_execute_string(&env, "'a' + true + 'b'", &res) && val_is_nan(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "n = 0; while (n < 100) { s = 'id=' + id + ',v=' + v + ';' + s.slice(0, 20); n = n + 1}", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s == 'id=device-0001,v=value;id=device-0001,v=val'", &res) && val_is_true(res));
+
+    env_deinit(&env);
+}
+
 static void test_exec_gc(void)
 {
     env_t env;
@@ -1163,7 +1654,7 @@ static void test_exec_op_add(void)
     CU_ASSERT(0 < interp_execute_string(&env, "1 + false", &res) && val_is_nan(res));
     CU_ASSERT(0 < interp_execute_string(&env, "1 + NaN", &res) && val_is_nan(res));
     CU_ASSERT(0 < interp_execute_string(&env, "1 + undefined", &res) && val_is_nan(res));
-    CU_ASSERT(0 < interp_execute_string(&env, "1 + ''", &res) && val_is_nan(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "1 + ''", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1"));
     CU_ASSERT(0 < interp_execute_string(&env, "1 + []", &res) && val_is_nan(res));
     CU_ASSERT(0 < interp_execute_string(&env, "1 + {}", &res) && val_is_nan(res));
     CU_ASSERT(0 < interp_execute_string(&env, "1 + def(){}", &res) && val_is_nan(res));
@@ -1172,7 +1663,7 @@ static void test_exec_op_add(void)
     CU_ASSERT(0 < interp_execute_string(&env, "false + 1", &res) && val_is_nan(res));
     CU_ASSERT(0 < interp_execute_string(&env, "NaN + 1", &res) && val_is_nan(res));
     CU_ASSERT(0 < interp_execute_string(&env, "undefined + 1", &res) && val_is_nan(res));
-    CU_ASSERT(0 < interp_execute_string(&env, "'' + 1", &res) && val_is_nan(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "'' + 1", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1"));
     CU_ASSERT(0 < interp_execute_string(&env, "[] + 1", &res) && val_is_nan(res));
     CU_ASSERT(0 < interp_execute_string(&env, "{} + 1", &res) && val_is_nan(res));
     CU_ASSERT(0 < interp_execute_string(&env, "def(){} + 1", &res) && val_is_nan(res));
@@ -1633,6 +2124,150 @@ static void test_exec_stmts(void)
     return;
 }
 
+static void test_exec_stream(void)
+{
+    env_t env;
+    val_t *res;
+    char script[2048];
+    int i, n = 0;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    // AST of the whole script is bigger than the free heap
+    n += sprintf(script + n, "var s = 0; def inc(x) { return x + 1 }\n");
+    for (i = 0; i < 60; i++) {
+        n += sprintf(script + n, "s = inc(s);\n");
+    }
+    n += sprintf(script + n, "def get() { return s } get()");
+
+    CU_ASSERT(0 < interp_execute_string(&env, script, &res) && val_is_number(res) && 60 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "inc(s) + get()", &res) && val_is_number(res) && 121 == val_2_integer(res));
+    CU_ASSERT(0 == interp_execute_string(&env, "", &res));
+
+    env_deinit(&env);
+    return;
+}
+
+static void test_exec_const_pool(void)
+{
+    env_t env;
+    val_t *res;
+    int num, str;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = 1.5, b = 'x', c = 'yz';", &res));
+    num = env.exe.number_num;
+    str = env.exe.string_num;
+
+    // constant should be reused
+    CU_ASSERT(0 < interp_execute_string(&env, "a = 1.5; b = 'x'; c = 'yz'; a == 1.5 && b == 'x'", &res) && val_is_true(res));
+    CU_ASSERT(num == env.exe.number_num);
+    CU_ASSERT(str == env.exe.string_num);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a = 2.5; c = 'yza'; a == 2.5 && c == 'yza'", &res) && val_is_true(res));
+    CU_ASSERT(num + 1 == env.exe.number_num);
+    CU_ASSERT(str + 1 == env.exe.string_num);
+
+    env_deinit(&env);
+    return;
+}
+
+static void test_exec_code_gc(void)
+{
+    env_t env;
+    val_t *res;
+    int i, ok = 1;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "def keep() { return 4.25 }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "def outer() { def inner() { return 'in' } return inner() }", &res));
+
+    // Old functions & constants should be reclaimed
+    for (i = 0; i < 500 && ok; i++) {
+        char buf[64];
+
+        sprintf(buf, "def f(x) { return x + %d.5 } f(1) == %d.5", i, i + 1);
+        ok = 0 < interp_execute_string(&env, buf, &res) && val_is_true(res);
+    }
+    CU_ASSERT(ok);
+
+    CU_ASSERT(0 == env_exe_gc(&env, 1));
+    CU_ASSERT(env.exe.func_num <= 5);
+    CU_ASSERT(0 < interp_execute_string(&env, "keep() == 4.25", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "outer() == 'in'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "f(2) == 501.5", &res) && val_is_true(res));
+
+    env_deinit(&env);
+    return;
+}
+
+static int exec_gc_count;
+
+static void test_exec_gc_counter(void)
+{
+    exec_gc_count++;
+}
+
+static void test_exec_code_gc_backoff(void)
+{
+    env_t env;
+    val_t *res;
+    int i, ok = 1;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_callback_set(&env, test_exec_gc_counter));
+
+    // Number constants of living function could not be reclaimed
+    CU_ASSERT(0 < interp_execute_string(&env, "def keep() { return 0.5 + 1.5 + 2.5 + 3.5 + 4.5 + 5.5 + 6.5 + 7.5 }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "def more() { return 8.5 + 9.5 + 10.5 + 11.5 + 12.5 + 13.5 + 14.5 + 15.5 }", &res));
+    CU_ASSERT(env.exe.number_num * 4 >= env.exe.number_max * 3);
+
+    // Not collected again and again, as nothing more is used
+    exec_gc_count = 0;
+    for (i = 0; i < 20 && ok; i++) {
+        ok = 0 < interp_execute_string(&env, "keep() + more() == 128", &res) && val_is_true(res);
+    }
+    CU_ASSERT(ok);
+    CU_ASSERT(exec_gc_count <= 1);
+
+    env_deinit(&env);
+    return;
+}
+
+static uint8_t eval_env_buf[128 * 1024];
+
+static void test_exec_string_gc(void)
+{
+    env_t env;
+    val_t *res;
+    int i, ok = 1;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, eval_env_buf, sizeof(eval_env_buf), NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    // String constants & their symbals are reclaimed, even no function defined
+    for (i = 0; i < 5000 && ok; i++) {
+        char buf[64];
+
+        sprintf(buf, "var v%d = 'k%d'; v%d == 'k%d'", i % 7, i, i % 7, i);
+        ok = 0 < interp_execute_string(&env, buf, &res) && val_is_true(res);
+    }
+    CU_ASSERT(ok);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "def f(x) { return x }", &res));
+    for (i = 0; i < 5000 && ok; i++) {
+        char buf[128];
+
+        sprintf(buf, "var s = f('k%d-abcdefghijklmnopqrstuvwxyz-abcdefghijklmnopqrstuvwxyz'); s.length()", i);
+        ok = 0 < interp_execute_string(&env, buf, &res) && val_is_number(res);
+    }
+    CU_ASSERT(ok);
+    CU_ASSERT(env.error == 0);
+
+    env_deinit(&env);
+}
+
 CU_pSuite test_lang_interp_entry()
 {
     CU_pSuite suite = CU_add_suite("lang execute", test_setup, test_clean);
@@ -1653,13 +2288,30 @@ CU_pSuite test_lang_interp_entry()
         CU_add_test(suite, "exec native",       test_exec_native);
         CU_add_test(suite, "exec native call",  test_exec_native_call_script);
         CU_add_test(suite, "exec string",       test_exec_string);
+        CU_add_test(suite, "exec string rope",  test_exec_string_rope);
+        CU_add_test(suite, "exec string slice", test_exec_string_slice);
+        CU_add_test(suite, "exec string search", test_exec_string_search);
+        CU_add_test(suite, "exec string intern", test_exec_string_intern);
+        CU_add_test(suite, "exec string concat", test_exec_string_concat);
+        CU_add_test(suite, "exec number to string", test_exec_number_to_string);
+        CU_add_test(suite, "exec number parse", test_exec_number_parse);
         CU_add_test(suite, "exec object",       test_exec_object);
         CU_add_test(suite, "exec array",        test_exec_array);
+        CU_add_test(suite, "exec array grow",   test_exec_array_grow);
+        CU_add_test(suite, "exec array number", test_exec_array_number);
+        CU_add_test(suite, "exec array native", test_exec_array_native);
+        CU_add_test(suite, "exec callback",     test_exec_callback);
+        CU_add_test(suite, "exec for",          test_exec_for);
         CU_add_test(suite, "exec closure",      test_exec_closure);
         CU_add_test(suite, "exec stack check",  test_exec_stack_check);
         CU_add_test(suite, "exec function arg", test_exec_func_arg);
         CU_add_test(suite, "exec gc",           test_exec_gc);
         CU_add_test(suite, "exec gc with ref",  test_exec_gc_reference);
+        CU_add_test(suite, "exec stream",       test_exec_stream);
+        CU_add_test(suite, "exec const pool",   test_exec_const_pool);
+        CU_add_test(suite, "exec code gc",      test_exec_code_gc);
+        CU_add_test(suite, "exec code gc backoff", test_exec_code_gc_backoff);
+        CU_add_test(suite, "exec string gc",    test_exec_string_gc);
 
         CU_add_test(suite, "exec op neg",       test_exec_op_neg);
         CU_add_test(suite, "exec op not",       test_exec_op_not);
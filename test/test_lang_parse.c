@@ -843,6 +843,33 @@ static void test_stmt_while(void)
     CU_ASSERT(stmt->expr->type == EXPR_TGT);
 }
 
+static void test_stmt_for(void)
+{
+    parser_t psr;
+    stmt_t   *stmt;
+    char     *input = "\
+    for k in a {\n\
+       b = b + k\n\
+    }\n\
+    for (var v of a) {\n\
+       b = b + v\n\
+    }\n";
+
+    parse_init(&psr, input, NULL, heap_buf, PSR_BUF_SIZE);
+
+    CU_ASSERT_FATAL(0 != (stmt = parse_stmt(&psr)));
+    CU_ASSERT(stmt->type == STMT_FOR_IN);
+    CU_ASSERT(stmt->expr->type == EXPR_PAIR);
+    CU_ASSERT(L_(stmt->expr)->type == EXPR_ID);
+    CU_ASSERT(R_(stmt->expr)->type == EXPR_ID);
+    CU_ASSERT(stmt->block != NULL);
+
+    CU_ASSERT_FATAL(0 != (stmt = parse_stmt(&psr)));
+    CU_ASSERT(stmt->type == STMT_FOR_OF);
+    CU_ASSERT(!strcmp(TEXT(L_(stmt->expr)), "v"));
+    CU_ASSERT(stmt->block != NULL);
+}
+
 static void test_stmt_try(void)
 {
     parser_t psr;
@@ -916,6 +943,7 @@ CU_pSuite test_lang_parse_entry()
         CU_add_test(suite, "parse statements simple",   test_stmt_simple);
         CU_add_test(suite, "parse statements if",       test_stmt_if);
         CU_add_test(suite, "parse statements while",    test_stmt_while);
+        CU_add_test(suite, "parse statements for",      test_stmt_for);
         CU_add_test(suite, "parse statements try",      test_stmt_try);
     }
 
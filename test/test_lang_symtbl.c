@@ -29,6 +29,19 @@ SOFTWARE.
 #include "cunit/CUnit.h"
 #include "cunit/CUnit_Basic.h"
 
+#include "lang/interp.h"
+#include "lang/type_string.h"
+
+#define STACK_SIZE      128
+#define HEAP_SIZE       4096
+
+#define EXE_MEM_SPACE   4096
+#define SYM_MEM_SPACE   8192
+#define ENV_BUF_SIZE    (sizeof(val_t) * STACK_SIZE + HEAP_SIZE + EXE_MEM_SPACE + SYM_MEM_SPACE)
+
+static uint8_t env_buf[ENV_BUF_SIZE];
+static uint8_t env_big_buf[2 * 1024 * 1024];
+
 static int test_setup()
 {
     return 0;
@@ -41,6 +54,188 @@ static int test_clean()
 
 static void test_symtbl_common(void)
 {
+    env_t env;
+    intptr_t syms[100];
+    char name[16];
+    int i, size;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    CU_ASSERT(0 == env_symbal_get(&env, "not_exist"));
+    CU_ASSERT(0 != (syms[0] = env_symbal_add(&env, "hello")));
+    CU_ASSERT(syms[0] == env_symbal_add(&env, "hello"));
+    CU_ASSERT(syms[0] == env_symbal_get(&env, "hello"));
+    CU_ASSERT(0 == strcmp("hello", (const char *)syms[0]));
+
+    // table should grow up
+    size = env.symbal_tbl_size;
+    for (i = 1; i < 100; i++) {
+        sprintf(name, "s%d", i);
+        syms[i] = env_symbal_add(&env, name);
+        CU_ASSERT_FATAL(syms[i] != 0);
+    }
+    CU_ASSERT(env.symbal_tbl_size > size);
+
+    for (i = 1; i < 100; i++) {
+        sprintf(name, "s%d", i);
+        CU_ASSERT(syms[i] == env_symbal_get(&env, name));
+        CU_ASSERT(0 == strcmp(name, (const char *)syms[i]));
+    }
+    CU_ASSERT(syms[0] == env_symbal_get(&env, "hello"));
+
+    env_deinit(&env);
+}
+
+static void test_symtbl_big_env(void)
+{
+    env_t env;
+    val_t *res;
+
+    // symbal area is bigger than 16 bits offset can reach
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_big_buf, sizeof(env_big_buf), NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(env.symbal_tbl_size == DEF_SYMBAL_TBL_SIZE);
+    CU_ASSERT(0 != env_symbal_add(&env, "hello"));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = {x: 1, y: 2}; a.x + a.y", &res) && val_is_number(res) && 3 == val_2_integer(res));
+
+    env_deinit(&env);
+}
+
+static void test_symtbl_compile_gc(void)
+{
+    env_t env;
+    val_t *res;
+    char name[16];
+    int i = 0;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interpreter(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    // Fill up symbal space with unused symbals, compiled again after they are collected
+    do {
+        sprintf(name, "unused%d", i++);
+    } while (env_symbal_add(&env, name));
+    env.error = 0;
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var first = 1, second = 2; first + second", &res) && val_is_number(res) && 3 == val_2_integer(res));
+    CU_ASSERT(0 == env_symbal_get(&env, "unused1"));
+
+    env_deinit(&env);
+
+    // Function compiled before the failed statement is not kept twice
+    CU_ASSERT_FATAL(0 == interp_env_init_interpreter(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 != env_symbal_add(&env, "f"));
+    do {
+        sprintf(name, "unused%d", i++);
+    } while (env_symbal_add(&env, name));
+    env.error = 0;
+
+    CU_ASSERT(0 < interp_execute_string(&env, "def f() { return 1 } var third = 3; f() + third", &res) && val_is_number(res) && 4 == val_2_integer(res));
+    CU_ASSERT(2 == env.exe.func_num);   // main & f
+
+    env_deinit(&env);
+}
+
+static void test_symtbl_gc_full(void)
+{
+    env_t env;
+    val_t *res;
+    char input[128];
+    int i, n, live;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interpreter(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    // Long constants stay alive, short symbals between them are garbage,
+    // symbal space is too full to hold a new table after collecting
+    for (n = 0; ; n++) {
+        sprintf(input, "junk%d", n);
+        if (!env_symbal_add(&env, input)) {
+            break;
+        }
+        sprintf(input, "'abcdefghijklmnopqrstuvwxyz_abcdefghijklmnopqrstuvwxyz_abcdefghijklmnopqrstuvwxyz_%d'", n);
+        if (0 >= interp_execute_string(&env, input, &res)) {
+            break;
+        }
+    }
+    env.error = 0;
+    env_heap_gc(&env, 0);
+
+    for (i = 0, live = 0; i < env.symbal_tbl_size; i++) {
+        if (env.symbal_tbl[i] > 0) {
+            live++;
+        }
+    }
+    CU_ASSERT(live == env.symbal_tbl_hold);
+
+    for (i = 0; i < n; i++) {
+        sprintf(input, "abcdefghijklmnopqrstuvwxyz_abcdefghijklmnopqrstuvwxyz_abcdefghijklmnopqrstuvwxyz_%d", i);
+        CU_ASSERT(0 != env_symbal_get(&env, input));
+    }
+    CU_ASSERT(0 == env_symbal_get(&env, "junk1"));
+    CU_ASSERT(0 != env_symbal_add(&env, "junk1"));
+
+    env_deinit(&env);
+}
+
+static void test_symtbl_gc_pending(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+
+    // New key is not referenced until the object grows up, gc should not drop it
+    CU_ASSERT(0 < interp_execute_string(&env, "var o = {}, i = 0, n = 0, cs = 'abcdefghijklmnopqrstuvwxyzABCD';", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (i < 30) { o['dead_symbol_' + cs[i]] = i; i = i + 1 }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "o.length() == 30 && n == 0", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "o.dead_symbol_a == 0 && o['dead_symbol_' + cs[29]] == 29", &res) && val_is_true(res));
+
+    env_deinit(&env);
+}
+
+static int key_count;
+
+static val_t test_native_key(env_t *env, int ac, val_t *av)
+{
+    char buf[16];
+    int n = sprintf(buf, "key%d", key_count++);
+    val_t s = string_create_heap_val(env, n);
+
+    (void) ac;
+    (void) av;
+    if (val_is_string(&s)) {
+        memcpy((char *)val_2_cstring(&s), buf, n);
+    }
+    return s;
+}
+
+static void test_symtbl_gc(void)
+{
+    env_t env;
+    val_t *res;
+    native_t native_entry[] = {
+        {"key", test_native_key},
+    };
+    int used;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, env_buf, ENV_BUF_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 1));
+
+    key_count = 0;
+    CU_ASSERT(0 < interp_execute_string(&env, "var keep = {}, o, i = 0; keep[key()] = 7;", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "while (i < 100) { o = {}; o[key()] = i; i = i + 1 }", &res));
+    env_heap_gc(&env, 0);
+    used = env.symbal_buf_used;
+
+    // Unused keys should be collected, memory keep flat
+    CU_ASSERT(0 < interp_execute_string(&env, "while (i < 2000) { o = {}; o[key()] = i; i = i + 1 }", &res));
+    CU_ASSERT(env.error == 0);
+    env_heap_gc(&env, 0);
+    CU_ASSERT(env.symbal_buf_used <= used + 2);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "keep['key0'] == 7", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "o['key2000'] == 1999", &res) && val_is_true(res));
+
+    env_deinit(&env);
 }
 
 CU_pSuite test_lang_symtbl_entry()
@@ -49,6 +244,11 @@ CU_pSuite test_lang_symtbl_entry()
 
     if (suite) {
         CU_add_test(suite, "symtbl common", test_symtbl_common);
+        CU_add_test(suite, "symtbl gc",     test_symtbl_gc);
+        CU_add_test(suite, "symtbl big env", test_symtbl_big_env);
+        CU_add_test(suite, "symtbl compile gc", test_symtbl_compile_gc);
+        CU_add_test(suite, "symtbl gc full", test_symtbl_gc_full);
+        CU_add_test(suite, "symtbl gc pending", test_symtbl_gc_pending);
     }
 
     return suite;
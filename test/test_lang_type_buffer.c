@@ -30,6 +30,7 @@ SOFTWARE.
 
 #include "lang/interp.h"
 #include "lang/type_buffer.h"
+#include "lang/checksum.h"
 
 #define STACK_SIZE      128
 #define HEAP_SIZE       4096
@@ -76,6 +77,9 @@ static void test_create(void)
     CU_ASSERT(0 < interp_execute_string(&env, "b[3] == 108", &res) && val_is_true(res));
     CU_ASSERT(0 < interp_execute_string(&env, "b[4] == 111", &res) && val_is_true(res));
     CU_ASSERT(0 < interp_execute_string(&env, "b[5]", &res) && val_is_undefined(res));
+
+    // size over heap should be refused, not wrap around
+    CU_ASSERT(0 > interp_execute_string(&env, "Buffer(2147483631)", &res));
 }
 
 static void test_write(void)
@@ -171,6 +175,200 @@ static void test_slice(void)
 
     CU_ASSERT(0 < interp_execute_string(&env, "d = b.slice(1, 3)", &res) && val_is_buffer(res));
     CU_ASSERT(0 < interp_execute_string(&env, "d.length() == 2", &res) && val_is_true(res));
+
+    // slice shares bytes with its parent, even after gc
+    CU_ASSERT(0 < interp_execute_string(&env, "d.writeInt(65, 1); b[2] == 65", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "d = b.slice(1).slice(2); d.length() == 2 && d[0] == 108", &res) && val_is_true(res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(0 < interp_execute_string(&env, "b.writeInt(33, 4); d[1] == 33 && d.toString() == 'l!'", &res) && val_is_true(res));
+
+    // out of range
+    CU_ASSERT(0 < interp_execute_string(&env, "b.slice(9).length() == 0 && b.slice(3, 1).length() == 0", &res) && val_is_true(res));
+}
+
+static void test_copy(void)
+{
+    env_t env;
+    val_t *res;
+    native_t native_entry[] = {
+        {"Buffer", buffer_native_create},
+    };
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 1));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var b = Buffer('hello'), d;", &res));
+
+    // copy is detached from the source
+    CU_ASSERT(0 < interp_execute_string(&env, "d = b.copy(1, 4); d.length() == 3 && d.toString() == 'ell'", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "d.writeInt(65, 0); b[1] == 101", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "d = b.slice(1).copy(); b.writeInt(65, 1); d.toString() == 'ello'", &res) && val_is_true(res));
+}
+
+static void test_field(void)
+{
+    env_t env;
+    val_t *res;
+    native_t native_entry[] = {
+        {"Buffer", buffer_native_create},
+    };
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 1));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var b = Buffer(16);", &res));
+
+    // byte order
+    CU_ASSERT(0 < interp_execute_string(&env, "b.writeUInt16BE(4660, 0) == 2 && b[0] == 18 && b[1] == 52", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.readUInt16LE(0) == 13330 && b.readUInt16BE(0) == 4660", &res) && val_is_true(res));
+
+    // signed & unsigned, at unaligned offset
+    CU_ASSERT(0 < interp_execute_string(&env, "b.writeInt32LE(-2, 1) == 5 && b.readInt32LE(1) == -2", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.readUInt32LE(1) == 4294967294 && b.readUInt32BE(1) == 4278190079", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.writeUInt8(255, 5); b.readInt8(5) == -1 && b.readUInt8(5) == 255", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.writeInt16BE(-300, 7); b.readInt16BE(7) == -300", &res) && val_is_true(res));
+
+    // floats
+    CU_ASSERT(0 < interp_execute_string(&env, "b.writeFloat32BE(1.5, 3); b.readFloat32BE(3) == 1.5 && b[3] == 63", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.writeFloat64LE(-0.1, 8); b.readFloat64LE(8) == -0.1", &res) && val_is_true(res));
+
+    // out of range
+    CU_ASSERT(0 < interp_execute_string(&env, "b.readUInt32LE(13)", &res) && val_is_undefined(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.writeFloat64BE(1, 9) == 0 && b.writeUInt8(1, -1) == 0", &res) && val_is_true(res));
+}
+
+static void test_unpack(void)
+{
+    env_t env;
+    val_t *res;
+    native_t native_entry[] = {
+        {"Buffer", buffer_native_create},
+    };
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 1));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var b = Buffer(24), a;", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b.pack('>BxHi2h', [1, 515, -7, 3, -4], 2)", &res) && val_is_number(res) && 14 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b[2] == 1 && b[4] == 2 && b[5] == 3 && b.readInt32BE(6) == -7", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a = b.unpack('!BxHi2h', 2); a.length()", &res) && val_is_number(res) && 5 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.join()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "1,515,-7,3,-4"));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b.pack('<fdQ', [0.5, 2.25, 4294967296])", &res) && val_is_number(res) && 20 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.unpack('fdQ').join()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "0.5,2.25,4294967296"));
+
+    // out of range, and invalid format
+    CU_ASSERT(0 < interp_execute_string(&env, "b.unpack('3q', 1)", &res) && val_is_undefined(res));
+    CU_ASSERT(0 > interp_execute_string(&env, "b.unpack('2z')", &res));
+}
+
+static void test_checksum(void)
+{
+    uint8_t data[1000];
+    int i;
+
+    for (i = 0; i < 1000; i++) {
+        data[i] = i * 31 + 7;
+    }
+
+    // long input, beyond the blocks of slicing and xxhash stripes
+    CU_ASSERT(0x8902161e == checksum_crc32(CHECKSUM_CRC32_INIT, data, 1000));
+    CU_ASSERT(0xff52ee97 == checksum_crc32c(CHECKSUM_CRC32_INIT, data, 1000));
+    CU_ASSERT(0xd9f3f1bc == checksum_adler32(CHECKSUM_ADLER32_INIT, data, 1000));
+    CU_ASSERT(0xa33b1355 == checksum_fnv1a(CHECKSUM_FNV1A_INIT, data, 1000));
+    CU_ASSERT(0x99594f4828043d35ull == checksum_xxhash64(0, data, 1000));
+    CU_ASSERT(0xa110dbef405c5a24ull == checksum_xxhash64(7, data, 100));
+    CU_ASSERT(0x62c9fd21ed857664ull == checksum_xxhash64(0, data, 33));
+
+    // continued
+    CU_ASSERT(0xff52ee97 == checksum_crc32c(checksum_crc32c(CHECKSUM_CRC32_INIT, data, 13), data + 13, 987));
+    CU_ASSERT(0xd9f3f1bc == checksum_adler32(checksum_adler32(CHECKSUM_ADLER32_INIT, data, 999), data + 999, 1));
+}
+
+static void test_checksum_native(void)
+{
+    env_t env;
+    val_t *res;
+    native_t native_entry[] = {
+        {"Buffer", buffer_native_create},
+    };
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 1));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var b = Buffer('123456789'), c;", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b.crc32()", &res) && val_is_number(res) && 0xcbf43926 == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.crc32c()", &res) && val_is_number(res) && 0xe3069283 == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.adler32()", &res) && val_is_number(res) && 0x091e01de == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.fnv1a()", &res) && val_is_number(res) && 0xbb86b11c == val_2_double(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "Buffer('abc').xxhash64()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "44bc2cf5ad770999"));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.xxhash64(9)", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "ef46db3751d8e999"));
+
+    // range, and continued over pieces
+    CU_ASSERT(0 < interp_execute_string(&env, "b.crc32(1, 3) == Buffer('23').crc32() && b.slice(2).crc32c() == b.crc32c(2)", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "c = b.crc32(0, 4); b.crc32(4, -1, c) == b.crc32()", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "c = b.adler32(0, 5); b.adler32(5, 9, c) == b.adler32()", &res) && val_is_true(res));
+}
+
+#define EXTERN_SIZE     (100000)
+
+static uint8_t extern_bytes[EXTERN_SIZE];
+static int extern_released;
+
+static void extern_release(void *data, int len)
+{
+    if (data == extern_bytes && len == EXTERN_SIZE) {
+        extern_released++;
+    }
+}
+
+static val_t extern_create(env_t *env, int ac, val_t *av)
+{
+    type_buffer_t *b;
+
+    (void) ac;
+    (void) av;
+
+    b = buffer_create_extern(env, extern_bytes, EXTERN_SIZE, extern_release);
+    return b ? val_mk_buffer(b) : VAL_UNDEFINED;
+}
+
+static void test_extern(void)
+{
+    env_t env;
+    val_t *res;
+    native_t native_entry[] = {
+        {"Buffer", buffer_native_create},
+        {"Extern", extern_create},
+    };
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 2));
+
+    extern_released = 0;
+    extern_bytes[1] = 7;
+    extern_bytes[EXTERN_SIZE - 1] = 9;
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var e = Extern(), d;", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "e.length() == 100000 && e[1] == 7 && e[99999] == 9", &res) && val_is_true(res));
+
+    // bytes are not moved by gc, slice of external buffer keeps it alive
+    CU_ASSERT(0 < interp_execute_string(&env, "d = e.slice(99990); e = Extern(); e.writeInt(3, 2)", &res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(extern_released == 0);
+    CU_ASSERT(0 < interp_execute_string(&env, "d.length() == 10 && d[9] == 9 && e[2] == 3", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "d = e.copy(0, 4); d[1] == 7", &res) && val_is_true(res));
+    env_heap_gc(&env, 0);
+    CU_ASSERT(extern_released == 1);
+
+    // release the rest
+    env_deinit(&env);
+    CU_ASSERT(extern_released == 2);
 }
 
 CU_pSuite test_lang_type_buffer(void)
@@ -182,6 +380,12 @@ CU_pSuite test_lang_type_buffer(void)
         CU_add_test(suite, "write",  test_write);
         CU_add_test(suite, "read",   test_read);
         CU_add_test(suite, "slice",  test_slice);
+        CU_add_test(suite, "copy",   test_copy);
+        CU_add_test(suite, "field",  test_field);
+        CU_add_test(suite, "unpack", test_unpack);
+        CU_add_test(suite, "checksum",        test_checksum);
+        CU_add_test(suite, "checksum native", test_checksum_native);
+        CU_add_test(suite, "extern", test_extern);
     }
     return suite;
 }
@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "cunit/CUnit.h"
+#include "cunit/CUnit_Basic.h"
+
+#include "lang/interp.h"
+#include "lang/type_buffer.h"
+#include "lang/type_builder.h"
+
+#define STACK_SIZE      128
+#define HEAP_SIZE       4096
+
+#define EXE_MEM_SPACE   4096
+#define SYM_MEM_SPACE   1024
+#define MEMORY_SIZE     (sizeof(val_t) * STACK_SIZE + HEAP_SIZE + EXE_MEM_SPACE + SYM_MEM_SPACE)
+
+static uint8_t builder_memory[MEMORY_SIZE];
+
+static const native_t native_entry[] = {
+    {"Buffer", buffer_native_create},
+    {"StringBuilder", builder_native_create},
+};
+
+static int test_setup()
+{
+    return 0;
+}
+
+static int test_clean()
+{
+    return 0;
+}
+
+static void test_create(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, builder_memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 2));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a, b;", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a = StringBuilder();", &res) && val_is_builder(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.length() == 0 && a.toString() == ''", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b = StringBuilder(100);", &res) && val_is_builder(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.length() == 0", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b = StringBuilder('hello');", &res) && val_is_builder(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.length() == 5 && b.toString() == 'hello'", &res) && val_is_true(res));
+}
+
+static void test_append(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, builder_memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 2));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var b = StringBuilder();", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b.append('temp: ', 25, ', ', -1.5).appendChar(59)", &res) && val_is_builder(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.toString()", &res) && val_is_string(res) && !strcmp(val_2_cstring(res), "temp: 25, -1.5;"));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.appendChar('!').append(Buffer('ok')).length()", &res) && val_is_number(res) && 18 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.toString() == 'temp: 25, -1.5;!ok'", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b.clear().append('x').toString() == 'x'", &res) && val_is_true(res));
+
+    CU_ASSERT(0 > interp_execute_string(&env, "b.append(b)", &res));
+    CU_ASSERT(env.error == ERR_InvalidInput);
+}
+
+static void test_gc(void)
+{
+    env_t env;
+    val_t *res;
+
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(&env, builder_memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(&env, native_entry, 2));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var b = StringBuilder(), n = 0, s;", &res));
+
+    // storage grow and be moved by gc
+    CU_ASSERT(0 < interp_execute_string(&env, "while (n < 60) { b.append('line ', n, ';'); n = n + 1 }", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.length()", &res) && val_is_number(res) && 470 == val_2_integer(res));
+    env_heap_gc(&env, 0);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "s = b.toString(); s.length() == 470", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "s.slice(0, 14) == 'line 0;line 1;' && s.slice(-8) == 'line 59;'", &res) && val_is_true(res));
+}
+
+CU_pSuite test_lang_type_builder(void)
+{
+    CU_pSuite suite = CU_add_suite("TYPE: StringBuilder", test_setup, test_clean);
+
+    if (suite) {
+        CU_add_test(suite, "create", test_create);
+        CU_add_test(suite, "append", test_append);
+        CU_add_test(suite, "gc",     test_gc);
+    }
+    return suite;
+}
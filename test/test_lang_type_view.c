@@ -0,0 +1,175 @@
+/*
+MIT License
+
+Copyright (c) 2016 Lixing Ding <ding.lixing@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cunit/CUnit.h"
+#include "cunit/CUnit_Basic.h"
+
+#include "lang/interp.h"
+#include "lang/type_buffer.h"
+#include "lang/type_view.h"
+
+#define STACK_SIZE      128
+#define HEAP_SIZE       4096
+
+#define EXE_MEM_SPACE   4096
+#define SYM_MEM_SPACE   1024
+#define MEMORY_SIZE     (sizeof(val_t) * STACK_SIZE + HEAP_SIZE + EXE_MEM_SPACE + SYM_MEM_SPACE)
+
+static uint8_t view_memory[MEMORY_SIZE];
+
+static const native_t native_entry[] = {
+    {"Buffer",          buffer_native_create},
+    {"Int8Array",       view_native_create_int8},
+    {"Uint8Array",      view_native_create_uint8},
+    {"Int16Array",      view_native_create_int16},
+    {"Int32Array",      view_native_create_int32},
+    {"Uint32Array",     view_native_create_uint32},
+    {"Float32Array",    view_native_create_float32},
+    {"Float64Array",    view_native_create_float64},
+};
+
+static int test_setup()
+{
+    return 0;
+}
+
+static int test_clean()
+{
+    return 0;
+}
+
+static void test_env_init(env_t *env)
+{
+    CU_ASSERT_FATAL(0 == interp_env_init_interactive(env, view_memory, MEMORY_SIZE, NULL, HEAP_SIZE, NULL, STACK_SIZE));
+    CU_ASSERT(0 == env_native_set(env, native_entry, sizeof(native_entry) / sizeof(native_t)));
+}
+
+static void test_create(void)
+{
+    env_t env;
+    val_t *res;
+
+    test_env_init(&env);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a, b, c;", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a = Int32Array(4);", &res) && val_is_view(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.length() == 4 && a[0] == 0 && a[3] == 0", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a[4]", &res) && val_is_undefined(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b = Float64Array([1.5, 2, 'x']);", &res) && val_is_view(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.length() == 3 && b[0] == 1.5 && b[1] == 2 && b[2] == 0", &res) && val_is_true(res));
+
+    // views share the bytes of buffer
+    CU_ASSERT(0 < interp_execute_string(&env, "c = Buffer(8); a = Uint8Array(c);", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b = Int16Array(c, 2, 2);", &res) && val_is_view(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.length() == 2 && a.length() == 8", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b[0] = -1; a[2] == 255 && a[3] == 255 && c[2] == 255", &res) && val_is_true(res));
+
+    CU_ASSERT(0 > interp_execute_string(&env, "Int32Array(c, 2)", &res));
+    CU_ASSERT(env.error == ERR_InvalidInput);
+}
+
+static void test_elem(void)
+{
+    env_t env;
+    val_t *res;
+
+    test_env_init(&env);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = Int8Array(2), u = Uint32Array(1), f = Float32Array(1);", &res));
+
+    // integer elements wrap around and truncate
+    CU_ASSERT(0 < interp_execute_string(&env, "a[0] = 200; a[1] = -3.7; a[0] == -56 && a[1] == -3", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "u[0] = -1; u[0] == 4294967295", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "f[0] = 0.5; f[0] == 0.5", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a[0] = 1; a[0] += 126; a[0]++; a[0]", &res) && val_is_number(res) && -128 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a[1] = 5; a[1]--", &res) && val_is_number(res) && 5 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a[1]", &res) && val_is_number(res) && 4 == val_2_integer(res));
+
+    // out of range is ignored
+    CU_ASSERT(0 < interp_execute_string(&env, "a[2] = 1; a[2]", &res) && val_is_undefined(res));
+}
+
+static void test_bulk(void)
+{
+    env_t env;
+    val_t *res;
+
+    test_env_init(&env);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = Int32Array(5), b = Int32Array([1, 2, 3, 4, 5]), f = Float64Array([0.5, -1, 2]);", &res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a.fill(2).sum()", &res) && val_is_number(res) && 10 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.fill(7, 1, 3); a[0] == 2 && a[1] == 7 && a[2] == 7 && a[3] == 2", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a.copy(b).add(b).sum()", &res) && val_is_number(res) && 30 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.mul(b)[4]", &res) && val_is_number(res) && 50 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.copy([9, 8], 3); a[2] == 18 && a[3] == 9 && a[4] == 8", &res) && val_is_true(res));
+
+    CU_ASSERT(0 < interp_execute_string(&env, "b.scale(2, 1); b[0] == 3 && b[4] == 11", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.add(-3).min() == 0 && b.max() == 8", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b.dot(b)", &res) && val_is_number(res) && 120 == val_2_integer(res));
+
+    // mixed kinds are converted
+    CU_ASSERT(0 < interp_execute_string(&env, "f.add(b); f[0] == 0.5 && f[1] == 1 && f[2] == 6", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "f.dot(b)", &res) && val_is_number(res) && 26 == val_2_integer(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "f.min() == 0.5 && f.max() == 6", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "Int8Array(0).max()", &res) && val_is_undefined(res));
+
+    CU_ASSERT(0 > interp_execute_string(&env, "a.add('x')", &res));
+    CU_ASSERT(env.error == ERR_InvalidInput);
+}
+
+static void test_gc(void)
+{
+    env_t env;
+    val_t *res;
+
+    test_env_init(&env);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "var a = Float64Array(16), b = Uint8Array(a.buffer(), 8, 8);", &res));
+    CU_ASSERT(0 < interp_execute_string(&env, "a.fill(1.5); b[0] = 0;", &res));
+    env_heap_gc(&env, 0);
+
+    CU_ASSERT(0 < interp_execute_string(&env, "a.sum() == 24 && a.buffer() == b.buffer()", &res) && val_is_true(res));
+    CU_ASSERT(0 < interp_execute_string(&env, "b[0] = 1; a[1] != 1.5 && a[0] == 1.5", &res) && val_is_true(res));
+}
+
+CU_pSuite test_lang_type_view(void)
+{
+    CU_pSuite suite = CU_add_suite("TYPE: typed view", test_setup, test_clean);
+
+    if (suite) {
+        CU_add_test(suite, "create", test_create);
+        CU_add_test(suite, "element", test_elem);
+        CU_add_test(suite, "bulk operations", test_bulk);
+        CU_add_test(suite, "gc",     test_gc);
+    }
+    return suite;
+}
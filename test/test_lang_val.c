@@ -137,6 +137,17 @@ static void test_val_set(void)
 
     val_set_boolean(&v, 1);
     CU_ASSERT(v == val_mk_boolean(1));
+
+    val_set_inner_string(&v, 'a');
+    CU_ASSERT(val_is_inline_string(&v) && !strcmp("a", val_2_cstring(&v)));
+
+    val_set_inline_string(&v, "", 0);
+    CU_ASSERT(val_is_inline_string(&v) && !strcmp("", val_2_cstring(&v)));
+    CU_ASSERT(!val_is_true(&v));
+
+    val_set_inline_string(&v, "hello", 5);
+    CU_ASSERT(val_is_inline_string(&v) && !strcmp("hello", val_2_cstring(&v)));
+    CU_ASSERT(val_is_true(&v));
 }
 
 CU_pSuite test_lang_val_entry()